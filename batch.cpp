@@ -0,0 +1,203 @@
+#include "batch.h"
+#include <algorithm> // max
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+// lines handed out or waiting to be written, per worker; bounds memory when one position is slow
+static const size_t WINDOW_PER_WORKER = 64;
+
+// one input line waiting for a worker
+struct BatchJob
+{
+    size_t sequence;   // position in the output
+    size_t lineNumber; // 1-based input line, reported back
+    std::string line;
+};
+
+// input lines on their way to the workers, and answers on their way out in input order
+struct BatchQueue
+{
+    std::mutex mutex;
+    std::condition_variable jobReady;
+    std::condition_variable spaceFree;
+
+    std::deque<BatchJob> jobs;
+    bool inputDone = false;
+
+    std::map<size_t, std::string> finished; // answers that still wait for an earlier one
+    size_t nextToWrite = 0;
+};
+
+/* finds "key": in a JSON object line and returns the raw value that
+follows, e.g. "\"3342\"" or "17". Enough for flat request objects, not a
+general parser: a value may not contain the characters , } or an escaped
+quote. */
+static bool jsonField(const std::string &line, const std::string &key, std::string &value)
+{
+    size_t pos = line.find("\"" + key + "\"");
+    if (pos == std::string::npos || (pos = line.find(':', pos + key.size() + 2)) == std::string::npos)
+    {
+        return false;
+    }
+    pos = line.find_first_not_of(" \t", pos + 1);
+    if (pos == std::string::npos)
+    {
+        return false;
+    }
+
+    size_t end = line[pos] == '"' ? line.find('"', pos + 1) + 1 : line.find_first_of(",}", pos);
+    if (end == 0 || end == std::string::npos)
+    {
+        return false;
+    }
+    value = line.substr(pos, end - pos);
+    value.erase(value.find_last_not_of(" \t") + 1);
+    return true;
+}
+
+// answers one input line (a move history or a JSON object with "history")
+static std::string analyseLine(Engine &engine, Searcher &worker, size_t lineNumber, const std::string &line)
+{
+    std::ostringstream response;
+    response << "{\"line\":" << lineNumber;
+
+    std::string history = line;
+    if (line[0] == '{')
+    {
+        std::string id;
+        if (jsonField(line, "id", id))
+        {
+            response << ",\"id\":" << id;
+        }
+        if (!jsonField(line, "history", history) || history.size() < 2 || history[0] != '"')
+        {
+            response << ",\"error\":\"missing history\"}";
+            return response.str();
+        }
+        history = history.substr(1, history.size() - 2);
+    }
+
+    Board position;
+    if (!Engine::parseHistory(history, position))
+    {
+        response << ",\"error\":\"illegal move history\"}";
+        return response.str();
+    }
+    if (position.checkWin())
+    {
+        response << ",\"error\":\"game is over\"}";
+        return response.str();
+    }
+    if (position.numMoves() == Board::CELLS)
+    {
+        response << ",\"error\":\"board is full\"}";
+        return response.str();
+    }
+
+    // Ages the table like a session's move, so earlier positions' entries are replaced first
+    engine.table().newSearch();
+    Analysis result = engine.analysePosition(position, worker);
+    response << ",\"history\":\"" << history << "\""
+             << ",\"move\":" << result.move
+             << ",\"score\":" << result.score
+             << ",\"book\":" << (result.book ? "true" : "false")
+             << ",\"proven\":" << (result.proven ? "true" : "false")
+             << ",\"nodes\":" << result.nodes
+             << ",\"time_ms\":" << result.timeMs << "}";
+    return response.str();
+}
+
+// takes lines off the queue until the input is exhausted, writing out every answer that is next in line
+static void batchWorker(Engine &engine, Searcher &worker, BatchQueue &queue, std::ostream &out)
+{
+    while (true)
+    {
+        BatchJob job;
+        {
+            std::unique_lock<std::mutex> lock(queue.mutex);
+            queue.jobReady.wait(lock, [&queue]
+                                { return !queue.jobs.empty() || queue.inputDone; });
+            if (queue.jobs.empty())
+            {
+                return;
+            }
+            job = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+        }
+
+        std::string answer = analyseLine(engine, worker, job.lineNumber, job.line);
+
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.finished[job.sequence] = std::move(answer);
+        bool wrote = false;
+        for (auto it = queue.finished.begin(); it != queue.finished.end() && it->first == queue.nextToWrite; it = queue.finished.erase(it))
+        {
+            out << it->second << "\n";
+            queue.nextToWrite++;
+            wrote = true;
+        }
+        if (wrote)
+        {
+            out.flush();
+            queue.spaceFree.notify_one();
+        }
+    }
+}
+
+// analyses every position read from in with the given number of workers
+void runBatch(Engine &engine, std::istream &in, std::ostream &out, int workers)
+{
+    workers = std::max(1, workers);
+    const size_t window = WINDOW_PER_WORKER * workers;
+    auto start = std::chrono::steady_clock::now();
+
+    BatchQueue queue;
+    std::vector<std::unique_ptr<Searcher>> searchers;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < workers; i++)
+    {
+        searchers.push_back(engine.newWorker(0));
+        Searcher *worker = searchers.back().get();
+        threads.emplace_back([&engine, worker, &queue, &out]()
+                             { batchWorker(engine, *worker, queue, out); });
+    }
+
+    std::string line;
+    size_t lineNumber = 0;
+    size_t sequence = 0;
+    while (std::getline(in, line))
+    {
+        lineNumber++;
+        line.erase(0, line.find_first_not_of(" \t"));
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        if (line.empty())
+        {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(queue.mutex);
+        queue.spaceFree.wait(lock, [&queue, sequence, window]
+                             { return sequence - queue.nextToWrite < window; });
+        queue.jobs.push_back({sequence, lineNumber, line});
+        sequence++;
+        queue.jobReady.notify_one();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.inputDone = true;
+    }
+    queue.jobReady.notify_all();
+    for (auto &th : threads)
+        th.join();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << "Analysed " << sequence << " positions in " << seconds << "s with " << workers << " workers ("
+              << (seconds > 0 ? sequence / seconds : 0.0) << " positions/s)\n";
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "engine.h"
+#include <iostream>
+#include <string>
+
+/*
+
+Batch analysis mode.
+
+Reads one position per line and answers every one of them with a pool of
+worker threads. Each worker has its own searcher and searches a position
+single-threaded; all of them share the engine's transposition table and
+opening book, so positions from the same games help each other.
+
+Input, one of these per line (blank lines are skipped):
+
+  3342                                  a move history
+  {"id":"g17","history":"3342"}         JSONL; "id" (any JSON value) is echoed back
+
+Output, one JSON line per input position, in input order, written as soon
+as every earlier position is done:
+
+  {"line":1,"history":"3342","move":2,"score":14,"book":false,"proven":false,"nodes":81234,"time_ms":12}
+  {"line":2,"id":"g17","error":"illegal move history"}
+
+"line" is the 1-based input line. --movetime and --nodes apply to each
+position on its own.
+
+*/
+
+// analyses every position read from in with the given number of workers
+void runBatch(Engine &engine, std::istream &in, std::ostream &out, int workers);
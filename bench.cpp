@@ -0,0 +1,531 @@
+#include "board.h"
+#include "boardkernels.h"
+#include "searcher.h"
+#include "transpositiontable.h"
+#include <algorithm> // sort
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/*
+
+Solver benchmark. Solves fixed sets of positions (positions/<set>.txt) from
+a cold transposition table, once with the depth-limited heuristic search
+and once with the exact solver, and prints time, node and table
+statistics per set as JSON:
+
+  ./bench                        every set, both modes
+  ./bench --mode strong          only the exact solver
+  ./bench --depth 12 --tt-mb 64  shallower heuristic search, smaller table
+  ./bench --mode multipv         every move of each position scored in one
+                                 search (exactly, and as win/draw/loss)
+                                 versus one solve per move
+  ./bench --generate             rebuilds the sets from self-play
+
+Every position is searched by a fresh single-threaded Searcher, so node
+counts are deterministic: a change in them means the search changed,
+while time and nodes per second track throughput.
+
+*/
+
+// a named set of positions, each given as a move history
+struct PositionSet
+{
+    std::string name;
+    std::vector<std::string> histories;
+};
+
+// what searching one position cost
+struct Sample
+{
+    double timeMs;
+    uint64_t nodes;
+    uint64_t ttProbes;
+    uint64_t ttHits;
+};
+
+// what scoring every legal move of one position cost
+struct MultiPvSample
+{
+    double timeMs;
+    uint64_t nodes;            // Searcher::solveMoves on a cold table
+    double wdlMs;
+    uint64_t wdlNodes;         // the same, scoring moves only as win, draw or loss
+    double independentMs;
+    uint64_t independentNodes; // one solve per move, each on a cold table
+    double sequentialMs;
+    uint64_t sequentialNodes;  // one solve per move in turn on one table, like a server asked once per column
+};
+
+// game phases the sets cover, as plies before the end of the game
+struct Phase
+{
+    const char *name;
+    int fromPly;
+    int toPly;
+};
+
+static const Phase PHASES[] = {
+    {"early", Board::CELLS - 30, Board::CELLS - 28}, // plies 12-14 on 7x6, where the engine starts solving
+    {"mid", Board::CELLS - 26, Board::CELLS - 22},
+    {"late", Board::CELLS - 20, Board::CELLS - 16},
+};
+
+// plays a move history, false if it is illegal or the game is already over
+static bool playHistory(const std::string &history, Board &board)
+{
+    board = Board();
+    for (char c : history)
+    {
+        int col = c - '0';
+        if (col < 0 || col >= Board::WIDTH || !board.makeMove(col) || board.checkWin())
+        {
+            return false;
+        }
+    }
+    return board.numMoves() < Board::CELLS;
+}
+
+// reads one set file: a move history per line, '#' starts a comment
+static bool loadSet(const std::string &path, PositionSet &set)
+{
+    std::ifstream in(path);
+    if (!in.is_open())
+    {
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(in, line))
+    {
+        std::string history = line.substr(0, line.find('#'));
+        history.erase(history.find_last_not_of(" \t\r") + 1);
+        Board board;
+        if (history.empty())
+        {
+            continue;
+        }
+        if (!playHistory(history, board))
+        {
+            std::cerr << path << ": skipping " << history << " (not a legal position on this board)\n";
+            continue;
+        }
+        set.histories.push_back(history);
+    }
+    return true;
+}
+
+// searches one position from a cold table
+static Sample searchPosition(TranspositionTable &table, const Board &board, bool strong, int depth)
+{
+    table.clear();
+    table.newSearch();
+    Searcher searcher(table, 0);
+    searcher.newSearch();
+    searcher.strongSolver = strong;
+
+    auto start = std::chrono::steady_clock::now();
+    if (strong)
+    {
+        searcher.solve(board);
+    }
+    else
+    {
+        int guess = 0;
+        for (int d = 1; d <= depth; d++)
+        {
+            guess = searcher.MTD(board, guess, d, false).first;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    Sample sample;
+    sample.timeMs = std::chrono::duration<double, std::milli>(end - start).count();
+    sample.nodes = searcher.nodesEvaluated;
+    sample.ttProbes = searcher.stats.ttProbes;
+    sample.ttHits = searcher.stats.ttHits;
+    return sample;
+}
+
+// nearest-rank percentile of sorted values
+template <class T>
+static T percentile(const std::vector<T> &sorted, double p)
+{
+    size_t rank = (size_t)std::ceil(p / 100.0 * sorted.size());
+    return sorted[std::max<size_t>(rank, 1) - 1];
+}
+
+// prints {"mean":..,"p50":..,"p99":..} for a list of values
+template <class T>
+static void printDistribution(std::ostream &out, std::vector<T> values)
+{
+    std::sort(values.begin(), values.end());
+    double sum = 0;
+    for (T v : values)
+    {
+        sum += (double)v;
+    }
+    out << "{\"mean\":" << sum / values.size()
+        << ",\"p50\":" << percentile(values, 50)
+        << ",\"p99\":" << percentile(values, 99) << "}";
+}
+
+// prints the statistics of one set in one mode
+static void printStats(std::ostream &out, const std::string &name, const char *mode, const std::vector<Sample> &samples)
+{
+    std::vector<double> times;
+    std::vector<uint64_t> nodes;
+    double totalMs = 0;
+    uint64_t totalNodes = 0, probes = 0, hits = 0;
+    for (const Sample &s : samples)
+    {
+        times.push_back(s.timeMs);
+        nodes.push_back(s.nodes);
+        totalMs += s.timeMs;
+        totalNodes += s.nodes;
+        probes += s.ttProbes;
+        hits += s.ttHits;
+    }
+
+    out << "{\"set\":\"" << name << "\",\"mode\":\"" << mode << "\",\"positions\":" << samples.size()
+        << ",\"time_ms\":";
+    printDistribution(out, times);
+    out << ",\"nodes\":";
+    printDistribution(out, nodes);
+    out << ",\"total_nodes\":" << totalNodes
+        << ",\"nps\":" << (uint64_t)(totalNodes / std::max(totalMs, 1e-3) * 1000.0)
+        << ",\"tt_hit_rate\":" << (probes ? (double)hits / probes : 0.0) << "}";
+}
+
+/* scores every move of a position with solveMoves, exactly and as win,
+draw or loss, then solves the position after each move on its own, once
+with a cold table per move and once keeping the table between moves */
+static MultiPvSample multiPvPosition(TranspositionTable &table, const Board &board)
+{
+    MultiPvSample sample;
+    for (bool exact : {true, false})
+    {
+        table.clear();
+        table.newSearch();
+        Searcher searcher(table, 0);
+        searcher.newSearch();
+        searcher.strongSolver = true;
+        auto start = std::chrono::steady_clock::now();
+        searcher.solveMoves(board, exact);
+        (exact ? sample.timeMs : sample.wdlMs) = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        (exact ? sample.nodes : sample.wdlNodes) = searcher.nodesEvaluated;
+    }
+
+    for (bool keepTable : {false, true})
+    {
+        double timeMs = 0;
+        uint64_t nodes = 0;
+        table.clear();
+        for (int col = 0; col < Board::WIDTH; col++)
+        {
+            Board child = board;
+            if (!child.checkMove(col) || !child.makeMove(col) || child.checkWin())
+            {
+                continue; // an immediate win needs no search
+            }
+            if (!keepTable)
+            {
+                table.clear();
+            }
+            table.newSearch();
+            Searcher moveSearcher(table, 0);
+            moveSearcher.newSearch();
+            moveSearcher.strongSolver = true;
+            auto moveStart = std::chrono::steady_clock::now();
+            moveSearcher.solve(child);
+            timeMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - moveStart).count();
+            nodes += moveSearcher.nodesEvaluated;
+        }
+        (keepTable ? sample.sequentialMs : sample.independentMs) = timeMs;
+        (keepTable ? sample.sequentialNodes : sample.independentNodes) = nodes;
+    }
+    return sample;
+}
+
+// prints the multi-PV cost of one set next to the cost of solving move by move
+static void printMultiPvStats(std::ostream &out, const std::string &name, const std::vector<MultiPvSample> &samples)
+{
+    MultiPvSample total = {0, 0, 0, 0, 0, 0, 0, 0};
+    for (const MultiPvSample &s : samples)
+    {
+        total.timeMs += s.timeMs;
+        total.nodes += s.nodes;
+        total.wdlMs += s.wdlMs;
+        total.wdlNodes += s.wdlNodes;
+        total.independentMs += s.independentMs;
+        total.independentNodes += s.independentNodes;
+        total.sequentialMs += s.sequentialMs;
+        total.sequentialNodes += s.sequentialNodes;
+    }
+
+    out << "{\"set\":\"" << name << "\",\"mode\":\"multipv\",\"positions\":" << samples.size()
+        << ",\"total_nodes\":" << total.nodes << ",\"time_ms\":" << total.timeMs
+        << ",\"wdl_nodes\":" << total.wdlNodes << ",\"wdl_time_ms\":" << total.wdlMs
+        << ",\"independent_nodes\":" << total.independentNodes << ",\"independent_time_ms\":" << total.independentMs
+        << ",\"sequential_nodes\":" << total.sequentialNodes << ",\"sequential_time_ms\":" << total.sequentialMs
+        << ",\"node_ratio_independent\":" << (double)total.nodes / std::max<uint64_t>(total.independentNodes, 1)
+        << ",\"node_ratio_sequential\":" << (double)total.nodes / std::max<uint64_t>(total.sequentialNodes, 1) << "}";
+}
+
+/* Plays self-play games to collect positions for every phase: a few
+random opening moves, then shallow searches with an occasional random
+move so the games do not all follow the same line. Each candidate is
+solved, and the cheaper half of a phase becomes its easy set, the rest
+its hard set. */
+static std::vector<PositionSet> generateSets(TranspositionTable &table, int perSet, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::vector<PositionSet> sets;
+
+    for (const Phase &phase : PHASES)
+    {
+        std::vector<std::pair<uint64_t, std::string>> candidates; // solve nodes, history
+        while ((int)candidates.size() < 2 * perSet)
+        {
+            int targetPly = phase.fromPly + (int)(rng() % (phase.toPly - phase.fromPly + 1));
+            Board board;
+            std::string history;
+            bool over = false;
+            while (board.numMoves() < targetPly && !over)
+            {
+                int col = -1;
+                if (board.numMoves() >= 4 && rng() % 8 != 0)
+                {
+                    table.clear();
+                    Searcher searcher(table, 0);
+                    searcher.newSearch();
+                    col = searcher.MTD(board, 0, 10, false).second;
+                }
+                while (col < 0 || !board.checkMove(col))
+                {
+                    col = (int)(rng() % Board::WIDTH);
+                }
+                board.makeMove(col);
+                history += (char)('0' + col);
+                over = board.checkWin() || board.numMoves() == Board::CELLS;
+            }
+
+            // Positions with an immediate win are solved without a search
+            if (over || board.canWinNext())
+            {
+                continue;
+            }
+
+            uint64_t nodes = searchPosition(table, board, true, 0).nodes;
+            candidates.push_back({nodes, history});
+            std::cerr << "\r" << phase.name << ": " << candidates.size() << "/" << 2 * perSet << std::flush;
+        }
+        std::cerr << "\n";
+
+        std::sort(candidates.begin(), candidates.end());
+        PositionSet easy{std::string(phase.name) + "_easy", {}}, hard{std::string(phase.name) + "_hard", {}};
+        for (size_t i = 0; i < candidates.size(); i++)
+        {
+            (i < candidates.size() / 2 ? easy : hard).histories.push_back(candidates[i].second);
+        }
+        sets.push_back(easy);
+        sets.push_back(hard);
+    }
+    return sets;
+}
+
+int main(int argc, char *argv[])
+{
+    std::string dir = "positions";
+    std::string mode = "both";
+    int depth = 14;
+    long ttMegabytes = 256;
+    bool generate = false;
+    int perSet = 24;
+    unsigned seed = 1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--dir" && i + 1 < argc)
+        {
+            dir = argv[++i];
+        }
+        else if (arg == "--mode" && i + 1 < argc)
+        {
+            mode = argv[++i];
+        }
+        else if (arg == "--depth" && i + 1 < argc)
+        {
+            depth = std::atoi(argv[++i]);
+        }
+        else if (arg == "--tt-mb" && i + 1 < argc)
+        {
+            ttMegabytes = std::atol(argv[++i]);
+        }
+        else if (arg == "--isa" && i + 1 < argc)
+        {
+            std::string isa = argv[++i];
+            if (!selectBoardKernels(isa))
+            {
+                std::cerr << "Unknown or unsupported --isa " << isa << ", using " << boardKernels->name << "\n";
+            }
+        }
+        else if (arg == "--generate")
+        {
+            generate = true;
+        }
+        else if (arg == "--count" && i + 1 < argc)
+        {
+            perSet = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (arg == "--seed" && i + 1 < argc)
+        {
+            seed = (unsigned)std::atol(argv[++i]);
+        }
+        else
+        {
+            std::cerr << "Unknown option " << arg << "\n";
+            return 1;
+        }
+    }
+
+    TranspositionTable table((size_t)std::max(1L, ttMegabytes));
+
+    // GENERATOR: `./bench --generate [--count 24] [--seed 1]` rewrites the set files
+    if (generate)
+    {
+        for (const PositionSet &set : generateSets(table, perSet, seed))
+        {
+            std::string path = dir + "/" + set.name + ".txt";
+            std::ofstream out(path);
+            if (!out.is_open())
+            {
+                std::cerr << "Could not write " << path << "\n";
+                return 1;
+            }
+            out << "# " << set.name << ": self-play positions on a " << Board::WIDTH << "x" << Board::HEIGHT
+                << " board (./bench --generate --count " << perSet << " --seed " << seed << ")\n";
+            for (const std::string &history : set.histories)
+            {
+                out << history << "\n";
+            }
+            std::cerr << "Wrote " << set.histories.size() << " positions to " << path << "\n";
+        }
+        return 0;
+    }
+
+    std::vector<PositionSet> sets;
+    for (const Phase &phase : PHASES)
+    {
+        for (const char *difficulty : {"easy", "hard"})
+        {
+            PositionSet set;
+            set.name = std::string(phase.name) + "_" + difficulty;
+            if (!loadSet(dir + "/" + set.name + ".txt", set))
+            {
+                std::cerr << "Missing " << dir << "/" << set.name << ".txt (run ./bench --generate)\n";
+                return 1;
+            }
+            if (!set.histories.empty())
+            {
+                sets.push_back(set);
+            }
+        }
+    }
+
+    if (sets.empty())
+    {
+        std::cerr << "No positions to search in " << dir << "\n";
+        return 1;
+    }
+
+    std::vector<const char *> modes;
+    if (mode == "multipv")
+    {
+        modes.push_back("multipv");
+    }
+    else
+    {
+        if (mode != "strong")
+        {
+            modes.push_back("heuristic");
+        }
+        if (mode != "heuristic")
+        {
+            modes.push_back("strong");
+        }
+    }
+
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3);
+    out << "{\"board\":\"" << Board::WIDTH << "x" << Board::HEIGHT << "\",\"kernels\":\"" << boardKernels->name
+        << "\",\"heuristic_depth\":" << depth << ",\"tt_mb\":" << table.sizeInMB() << ",\"results\":[";
+
+    // One untimed search first, so no timed search pays for faulting in the table's pages
+    {
+        Board board;
+        playHistory(sets[0].histories[0], board);
+        searchPosition(table, board, true, depth);
+    }
+
+    bool first = true;
+    for (const char *m : modes)
+    {
+        if (std::string(m) == "multipv")
+        {
+            std::vector<MultiPvSample> all;
+            for (const PositionSet &set : sets)
+            {
+                std::vector<MultiPvSample> samples;
+                for (const std::string &history : set.histories)
+                {
+                    Board board;
+                    playHistory(history, board);
+                    samples.push_back(multiPvPosition(table, board));
+                    std::cerr << "\r" << m << " " << set.name << ": " << samples.size() << "/" << set.histories.size() << "   " << std::flush;
+                }
+                all.insert(all.end(), samples.begin(), samples.end());
+
+                out << (first ? "\n" : ",\n");
+                printMultiPvStats(out, set.name, samples);
+                first = false;
+            }
+            out << ",\n";
+            printMultiPvStats(out, "all", all);
+            continue;
+        }
+
+        bool strong = std::string(m) == "strong";
+        std::vector<Sample> all;
+        for (const PositionSet &set : sets)
+        {
+            std::vector<Sample> samples;
+            for (const std::string &history : set.histories)
+            {
+                Board board;
+                playHistory(history, board);
+                samples.push_back(searchPosition(table, board, strong, depth));
+                std::cerr << "\r" << m << " " << set.name << ": " << samples.size() << "/" << set.histories.size() << "   " << std::flush;
+            }
+            all.insert(all.end(), samples.begin(), samples.end());
+
+            out << (first ? "\n" : ",\n");
+            printStats(out, set.name, m, samples);
+            first = false;
+        }
+        out << ",\n";
+        printStats(out, "all", m, all);
+    }
+    std::cerr << "\n";
+    out << "\n]}\n";
+    std::cout << out.str();
+    return 0;
+}
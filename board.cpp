@@ -1,6 +1,9 @@
 #include "board.h"
+#include "boardkernels.h"
+#include "platform.h"
 #include <iostream>
 #include <cstdint>
+#include <string>
 
 // adds color to the console output for better visualization of the board
 #define RESET "\033[0m"
@@ -8,25 +11,119 @@
 #define YELLOW "\033[33m"
 #define BLUE "\033[34m"
 
+/* Cells in the columns near the middle: those whose distance |2c - (W - 1)|
+from the middle is below spread, counting only the bottom `rows` cells of
+each column. On an odd-width board spread 2 is the center column; on an
+even-width board it is the two middle columns. */
+template <int W, int H>
+static constexpr typename BasicBoard<W, H>::Bitboard middleCells(int spread, int rows)
+{
+    typename BasicBoard<W, H>::Bitboard cells = 0;
+    for (int col = 0; col < W; col++)
+    {
+        int distance = 2 * col - (W - 1) < 0 ? (W - 1) - 2 * col : 2 * col - (W - 1);
+        if (distance < spread)
+        {
+            cells |= (((typename BasicBoard<W, H>::Bitboard)1 << rows) - 1) << (col * (H + 1));
+        }
+    }
+    return cells;
+}
+
+// every other row of the board, starting at firstRow
+template <int W, int H>
+static constexpr typename BasicBoard<W, H>::Bitboard alternateRows(int firstRow)
+{
+    typename BasicBoard<W, H>::Bitboard cells = 0;
+    for (int col = 0; col < W; col++)
+    {
+        for (int row = firstRow; row < H; row += 2)
+        {
+            cells |= (typename BasicBoard<W, H>::Bitboard)1 << (col * (H + 1) + row);
+        }
+    }
+    return cells;
+}
+
+// evaluation regions, see score()
+template <int W, int H>
+static constexpr typename BasicBoard<W, H>::Bitboard CENTER_MASK = middleCells<W, H>(2, H);
+template <int W, int H>
+static constexpr typename BasicBoard<W, H>::Bitboard INNER_MIDDLE_MASK = middleCells<W, H>(4, H) ^ CENTER_MASK<W, H>;
+template <int W, int H>
+static constexpr typename BasicBoard<W, H>::Bitboard SWEET_SPOT_MASK = middleCells<W, H>(4, 3);
+template <int W, int H>
+static constexpr typename BasicBoard<W, H>::Bitboard ROW_0_2_4 = alternateRows<W, H>(0); // 0x15 = 0010101 in every column of a 7x6 board
+template <int W, int H>
+static constexpr typename BasicBoard<W, H>::Bitboard ROW_1_3_5 = alternateRows<W, H>(1); // 0x2A = 0101010 in every column of a 7x6 board
+
+/* What a single disc on each cell adds to score() for player 1 (who
+controls rows 0, 2, 4) and player 2 (rows 1, 3, 5), apart from the
+patterns it is part of. */
+template <int W, int H>
+struct CellWeights
+{
+    int weight[2][W * (H + 1)];
+};
+
+template <int W, int H>
+static constexpr CellWeights<W, H> makeCellWeights()
+{
+    typedef typename BasicBoard<W, H>::Bitboard Bitboard;
+    CellWeights<W, H> table{};
+    for (int player = 0; player < 2; player++)
+    {
+        Bitboard parity = player == 0 ? ROW_0_2_4<W, H> : ROW_1_3_5<W, H>;
+        for (int cell = 0; cell < W * (H + 1); cell++)
+        {
+            Bitboard bit = (Bitboard)1 << cell;
+            table.weight[player][cell] = ((CENTER_MASK<W, H> & bit) ? 3 : 0) +
+                                         ((INNER_MIDDLE_MASK<W, H> & bit) ? 1 : 0) +
+                                         ((SWEET_SPOT_MASK<W, H> & bit) ? 4 : 0) +
+                                         ((parity & bit) ? 2 : 0);
+        }
+    }
+    return table;
+}
+
+template <int W, int H>
+static constexpr CellWeights<W, H> CELL_WEIGHTS = makeCellWeights<W, H>();
+
+// counts the set bits of a bitboard of either width
+static inline int bitCount(uint64_t x)
+{
+    return popcount64(x);
+}
+
+#ifdef C4_WIDE_BITBOARD
+static inline int bitCount(uint128_bits x)
+{
+    return popcount64((uint64_t)x) + popcount64((uint64_t)(x >> 64));
+}
+#endif
+
 // gets number of moves
-int Board::numMoves() const
+template <int W, int H>
+int BasicBoard<W, H>::numMoves() const
 {
     return numberMoves;
 }
 
 // determines if a move is valid
-bool Board::checkMove(int columnNumber) const
+template <int W, int H>
+bool BasicBoard<W, H>::checkMove(int columnNumber) const
 {
-    /* Shifts a 64-bit number equal to 1 to the desired
+    /* Shifts a bitboard equal to 1 to the desired
     column but shifting my the column number times the
-    number of rows. Then, adds 5 to get from the botton
+    number of rows. Then, adds H - 1 to get from the botton
     row to the top. Checks with the entire board to
     determine if the position is empty.*/
-    return (mask & (1ULL << (5 + columnNumber * 7))) == 0;
+    return (mask & ((Bitboard)1 << (H - 1 + columnNumber * STRIDE))) == 0;
 }
 
 // makes a move if it is valid
-bool Board::makeMove(const int columnNumber)
+template <int W, int H>
+bool BasicBoard<W, H>::makeMove(const int columnNumber)
 {
     // determines if the desired move is valid
     if (!checkMove(columnNumber))
@@ -34,13 +131,18 @@ bool Board::makeMove(const int columnNumber)
         return false;
     }
 
+    // Player 1 moves on even move counts and adds to the positional score, player 2 subtracts
+    int cell = columnNumber * STRIDE + bitCount(mask & columnMask(columnNumber));
+    int player = numberMoves & 1;
+    positionalScore += player ? -CELL_WEIGHTS<W, H>.weight[1][cell] : CELL_WEIGHTS<W, H>.weight[0][cell];
+
     // Uses XOR to switch between players
     currentPosition ^= mask;
 
     /* Makes a move by shifting a 1 to the desired
     column and row, adds it to the mask, and then
     use the OR operator to set the bit in the mask.*/
-    mask |= mask + (1ULL << (columnNumber * 7));
+    mask |= mask + ((Bitboard)1 << (columnNumber * STRIDE));
 
     numberMoves++;
 
@@ -49,19 +151,20 @@ bool Board::makeMove(const int columnNumber)
 }
 
 // checks for a win condition for the current player
-bool Board::checkWin() const
+template <int W, int H>
+bool BasicBoard<W, H>::checkWin() const
 {
     /* When you do four shifts and use the AND
     operator to either return a binary 1 and 0,
     it will check to see if any 1 aligns with
     another 1 and return true if so. */
     // We check the opponent's pieces because they are the one who just moved.
-    uint64_t pos = currentPosition ^ mask;
-    uint64_t m;
+    Bitboard pos = currentPosition ^ mask;
+    Bitboard m;
 
     // Horizontal Check
-    m = pos & (pos >> 7);
-    if (m & (m >> 14))
+    m = pos & (pos >> STRIDE);
+    if (m & (m >> (2 * STRIDE)))
     {
         return true;
     }
@@ -74,15 +177,15 @@ bool Board::checkWin() const
     }
 
     // Diagonal 1 Check (\)
-    m = pos & (pos >> 8);
-    if (m & (m >> 16))
+    m = pos & (pos >> (STRIDE + 1));
+    if (m & (m >> (2 * STRIDE + 2)))
     {
         return true;
     }
 
     // Diagonal 2 Check (/)
-    m = pos & (pos >> 6);
-    if (m & (m >> 12))
+    m = pos & (pos >> (STRIDE - 1));
+    if (m & (m >> (2 * STRIDE - 2)))
     {
         return true;
     }
@@ -90,189 +193,253 @@ bool Board::checkWin() const
     return false;
 }
 
+// gets the cells of one column (without its ghost row cell)
+template <int W, int H>
+typename BasicBoard<W, H>::Bitboard BasicBoard<W, H>::columnMask(int columnNumber)
+{
+    return COLUMN_CELLS << (columnNumber * STRIDE);
+}
+
+// gets the cells a move can be played in right now (the lowest empty cell of each column)
+template <int W, int H>
+typename BasicBoard<W, H>::Bitboard BasicBoard<W, H>::possible() const
+{
+    /* Adding the bottom row to the mask carries into the first empty cell
+    of every column. Full columns carry into the ghost row, which the board
+    mask removes. */
+    return (mask + BOTTOM_MASK) & BOARD_MASK;
+}
+
+/* gets every empty cell that would complete four in a row for pos on a
+board filled as in occupied, whether or not that cell can be played yet. */
+template <int W, int H>
+typename BasicBoard<W, H>::Bitboard BasicBoard<W, H>::winningCells(Bitboard pos, Bitboard occupied)
+{
+    // Vertical: three pieces directly below
+    Bitboard r = (pos << 1) & (pos << 2) & (pos << 3);
+    Bitboard p;
+
+    // Horizontal (Shift STRIDE): the empty cell can be at any of the four spots
+    const int h = STRIDE;
+    p = (pos << h) & (pos << (2 * h));
+    r |= p & (pos << (3 * h));
+    r |= p & (pos >> h);
+    p = (pos >> h) & (pos >> (2 * h));
+    r |= p & (pos << h);
+    r |= p & (pos >> (3 * h));
+
+    // Diagonal 1 (Shift STRIDE - 1)
+    const int d1 = STRIDE - 1;
+    p = (pos << d1) & (pos << (2 * d1));
+    r |= p & (pos << (3 * d1));
+    r |= p & (pos >> d1);
+    p = (pos >> d1) & (pos >> (2 * d1));
+    r |= p & (pos << d1);
+    r |= p & (pos >> (3 * d1));
+
+    // Diagonal 2 (Shift STRIDE + 1)
+    const int d2 = STRIDE + 1;
+    p = (pos << d2) & (pos << (2 * d2));
+    r |= p & (pos << (3 * d2));
+    r |= p & (pos >> d2);
+    p = (pos >> d2) & (pos >> (2 * d2));
+    r |= p & (pos << d2);
+    r |= p & (pos >> (3 * d2));
+
+    return r & (BOARD_MASK ^ occupied);
+}
+
+// gets the empty cells that would win for the player to move
+template <int W, int H>
+typename BasicBoard<W, H>::Bitboard BasicBoard<W, H>::winningPositions() const
+{
+    return winningCells(currentPosition, mask);
+}
+
+// gets the empty cells that would win for the player who just moved
+template <int W, int H>
+typename BasicBoard<W, H>::Bitboard BasicBoard<W, H>::opponentWinningPositions() const
+{
+    return winningCells(currentPosition ^ mask, mask);
+}
+
+// checks if the player to move can win immediately
+template <int W, int H>
+bool BasicBoard<W, H>::canWinNext() const
+{
+    return (winningPositions() & possible()) != 0;
+}
+
+/* gets the moves that do not lose on the spot. If the opponent threatens
+to win in a playable cell we must block it (and lose anyway if there are
+two such cells), and we must never play directly underneath a cell the
+opponent would win in, since that makes it playable for them. */
+template <int W, int H>
+typename BasicBoard<W, H>::Bitboard BasicBoard<W, H>::possibleNonLosingMoves() const
+{
+    Bitboard possibleMask = possible();
+    Bitboard opponentWin = opponentWinningPositions();
+    Bitboard forcedMoves = possibleMask & opponentWin;
+
+    if (forcedMoves)
+    {
+        if (forcedMoves & (forcedMoves - 1))
+        {
+            return 0; // two threats at once cannot both be blocked
+        }
+        possibleMask = forcedMoves;
+    }
+    return possibleMask & ~(opponentWin >> 1);
+}
+
+/* counts the winning cells the player to move would have after playing
+a column (a cheap estimate of how strong the move is, for move ordering). */
+template <int W, int H>
+int BasicBoard<W, H>::threatsAfterMove(int columnNumber) const
+{
+    Bitboard move = possible() & columnMask(columnNumber);
+    return bitCount(winningCells(currentPosition | move, mask | move));
+}
+
 // helper function for score evaluation
-int Board::countPatterns(uint64_t pos) const
+template <int W, int H>
+int BasicBoard<W, H>::countPatterns(Bitboard pos) const
 {
-    uint64_t empty = ~(mask);
-
-    // Accumulators for each score weight.
-    uint64_t w50 = 0, w10 = 0, w7 = 0, w5 = 0, w3 = 0, w2 = 0;
-
-    // --- HORIZONTAL (Shift 7) ---
-    uint64_t p_7 = pos >> 7, p_14 = pos >> 14, p_21 = pos >> 21;
-    uint64_t e_7 = empty >> 7, e_14 = empty >> 14, e_21 = empty >> 21;
-
-    w50 |= empty & p_7 & p_14 & p_21 & (empty >> 28); // _XXX_
-
-    w10 |= pos & e_7 & p_14 & p_21; // X_XX
-    w10 |= pos & p_7 & e_14 & p_21; // XX_X
-
-    w7 |= pos & p_7 & p_14 & e_21;   // XXX_
-    w7 |= empty & p_7 & p_14 & p_21; // _XXX
-
-    w3 |= pos & p_7 & e_14 & e_21;   // XX__
-    w3 |= empty & e_7 & p_14 & p_21; // __XX
-    w3 |= pos & e_7 & e_14 & p_21;   // X__X
-    w3 |= empty & p_7 & p_14 & e_21; // _XX_
-    w3 |= pos & e_7 & p_14 & e_21;   // X_X_
-    w3 |= empty & p_7 & e_14 & p_21; // _X_X
-
-    w2 |= pos & p_7 & e_14;   // XX_
-    w2 |= empty & p_7 & p_14; // _XX
-    w2 |= pos & e_7 & p_14;   // X_X
-
-    // --- VERTICAL (Shift 1) ---
-    uint64_t p_1 = pos >> 1, p_2 = pos >> 2;
-    uint64_t e_2 = empty >> 2, e_3 = empty >> 3;
-
-    w5 |= pos & p_1 & p_2 & e_3; // XXX_ (Vertical only open on top)
-    w2 |= pos & p_1 & e_2;       // XX_
-
-    // --- DIAGONAL 1 (Shift 8) ---
-    uint64_t p_8 = pos >> 8, p_16 = pos >> 16, p_24 = pos >> 24;
-    uint64_t e_8 = empty >> 8, e_16 = empty >> 16, e_24 = empty >> 24;
-
-    w10 |= pos & e_8 & p_16 & p_24;
-    w10 |= pos & p_8 & e_16 & p_24;
-
-    w7 |= pos & p_8 & p_16 & e_24;
-    w7 |= empty & p_8 & p_16 & p_24;
-
-    w3 |= pos & p_8 & e_16 & e_24;
-    w3 |= empty & e_8 & p_16 & p_24;
-    w3 |= pos & e_8 & e_16 & p_24;
-    w3 |= empty & p_8 & p_16 & e_24;
-    w3 |= pos & e_8 & p_16 & e_24;
-    w3 |= empty & p_8 & e_16 & p_24;
-
-    w2 |= pos & p_8 & e_16;
-    w2 |= empty & p_8 & p_16;
-    w2 |= pos & e_8 & p_16;
-
-    // --- DIAGONAL 2 (Shift 6) ---
-    uint64_t p_6 = pos >> 6, p_12 = pos >> 12, p_18 = pos >> 18;
-    uint64_t e_6 = empty >> 6, e_12 = empty >> 12, e_18 = empty >> 18;
-
-    w10 |= pos & e_6 & p_12 & p_18;
-    w10 |= pos & p_6 & e_12 & p_18;
-
-    w7 |= pos & p_6 & p_12 & e_18;
-    w7 |= empty & p_6 & p_12 & p_18;
-
-    w3 |= pos & p_6 & e_12 & e_18;
-    w3 |= empty & e_6 & p_12 & p_18;
-    w3 |= pos & e_6 & e_12 & p_18;
-    w3 |= empty & p_6 & p_12 & e_18;
-    w3 |= pos & e_6 & p_12 & e_18;
-    w3 |= empty & p_6 & e_12 & p_18;
-
-    w2 |= pos & p_6 & e_12;
-    w2 |= empty & p_6 & p_12;
-    w2 |= pos & e_6 & p_12;
-
-    // Execute popcounts only once per weight class
-    return ((int)__popcnt64(w50) * 50) +
-           ((int)__popcnt64(w10) * 10) +
-           ((int)__popcnt64(w7) * 7) +
-           ((int)__popcnt64(w5) * 5) +
-           ((int)__popcnt64(w3) * 3) +
-           ((int)__popcnt64(w2) * 2);
+    return boardKernels->countPatterns(pos, mask);
 }
 
 // gets the score of the current position
-int Board::score() const
+template <int W, int H>
+int BasicBoard<W, H>::score() const
 {
     if (checkWin())
     {
         return -1000; // If last move won, bad for current (to move) — but negamax checks this before eval
     }
 
-    uint64_t opp_pieces = currentPosition ^ mask; // Last player (opponent to current)
-    uint64_t cur_pieces = currentPosition;        // Current player
+    Bitboard opp_pieces = currentPosition ^ mask; // Last player (opponent to current)
+    Bitboard cur_pieces = currentPosition;        // Current player
 
     int cur_score = countPatterns(cur_pieces);
     int opp_score = countPatterns(opp_pieces);
 
     // score based on position in center
-    uint64_t centerMask = 0x3FULL << 21;
-    uint64_t innerMiddleMask = (0x3FULL << 14) | (0x3FULL << 28);
-
-    cur_score += (int)__popcnt64(cur_pieces & centerMask) * 3;
-    opp_score += (int)__popcnt64(opp_pieces & centerMask) * 3;
-    cur_score += (int)__popcnt64(cur_pieces & innerMiddleMask) * 1;
-    opp_score += (int)__popcnt64(opp_pieces & innerMiddleMask) * 1;
+    cur_score += bitCount(cur_pieces & CENTER_MASK<W, H>) * 3;
+    opp_score += bitCount(opp_pieces & CENTER_MASK<W, H>) * 3;
+    cur_score += bitCount(cur_pieces & INNER_MIDDLE_MASK<W, H>) * 1;
+    opp_score += bitCount(opp_pieces & INNER_MIDDLE_MASK<W, H>) * 1;
 
     // score based on position in bottom 3 rows and center 3 columns
-    uint64_t sweetSpotMask = (0x7ULL << 14) | (0x7ULL << 21) | (0x7ULL << 28);
-    cur_score += (int)__popcnt64(cur_pieces & sweetSpotMask) * 4;
-    opp_score += (int)__popcnt64(opp_pieces & sweetSpotMask) * 4;
+    cur_score += bitCount(cur_pieces & SWEET_SPOT_MASK<W, H>) * 4;
+    opp_score += bitCount(opp_pieces & SWEET_SPOT_MASK<W, H>) * 4;
 
     /* score based on parity of pieces in rows to encourage controlling the
     mathematically advantageous rows and force opponent into disadvantageous
     rows. The bottom 3 rows and center 3 columns are the most important for
     this, so we focus on those. */
-    // 0x15 = 0010101 (Rows 0, 2, 4). 0x2A = 0101010 (Rows 1, 3, 5).
-    uint64_t colEven = 0x15ULL;
-    uint64_t colOdd = 0x2AULL;
-
-    // Spread the column pattern across all 7 columns
-    uint64_t ROW_0_2_4 = colEven | (colEven << 7) | (colEven << 14) | (colEven << 21) | (colEven << 28) | (colEven << 35) | (colEven << 42);
-    uint64_t ROW_1_3_5 = colOdd | (colOdd << 7) | (colOdd << 14) | (colOdd << 21) | (colOdd << 28) | (colOdd << 35) | (colOdd << 42);
-
     bool isCurrentP1 = (numberMoves % 2 == 0);
-    uint64_t myParity = isCurrentP1 ? ROW_0_2_4 : ROW_1_3_5;
-    uint64_t oppParity = isCurrentP1 ? ROW_1_3_5 : ROW_0_2_4;
+    Bitboard myParity = isCurrentP1 ? ROW_0_2_4<W, H> : ROW_1_3_5<W, H>;
+    Bitboard oppParity = isCurrentP1 ? ROW_1_3_5<W, H> : ROW_0_2_4<W, H>;
 
     // Award points for aligning pieces with the rows you mathematically control
-    cur_score += (int)__popcnt64(cur_pieces & myParity) * 2;
-    opp_score += (int)__popcnt64(opp_pieces & oppParity) * 2;
+    cur_score += bitCount(cur_pieces & myParity) * 2;
+    opp_score += bitCount(opp_pieces & oppParity) * 2;
 
     return cur_score - opp_score; // Positive if good for current player, negative if good for opponent
 }
 
+/* scores the board exactly like score(), but the center, sweet-spot and
+parity terms were already summed disc by disc in makeMove, so only the
+patterns are counted here. */
+template <int W, int H>
+int BasicBoard<W, H>::incrementalScore() const
+{
+    if (checkWin())
+    {
+        return -1000;
+    }
+
+    int patterns;
+    boardKernels->patternBalance(&currentPosition, &mask, 1, &patterns);
+    return patterns + ((numberMoves & 1) ? -positionalScore : positionalScore);
+}
+
+/* Scores several boards at once, with exactly the values incrementalScore()
+gives them. The boards must not be won (checkWin() is not evaluated);
+negamax uses this for the children of a depth-1 node, which it only
+reaches once it knows no move wins immediately. */
+template <int W, int H>
+void BasicBoard<W, H>::scoreBatch(const BasicBoard *boards, int count, int *scores)
+{
+    Bitboard current[8], masks[8];
+    for (int start = 0; start < count; start += 8)
+    {
+        int used = count - start < 8 ? count - start : 8;
+        for (int i = 0; i < used; i++)
+        {
+            current[i] = boards[start + i].currentPosition;
+            masks[i] = boards[start + i].mask;
+        }
+
+        boardKernels->patternBalance(current, masks, used, scores + start);
+
+        for (int i = 0; i < used; i++)
+        {
+            const BasicBoard &b = boards[start + i];
+            scores[start + i] += (b.numberMoves & 1) ? -b.positionalScore : b.positionalScore;
+        }
+    }
+}
+
 // old scoring method for testing purposes
-int Board::oldScore() const
+template <int W, int H>
+int BasicBoard<W, H>::oldScore() const
 {
     if (checkWin())
     {
         return -1000;
     }
 
-    uint64_t opp_pieces = currentPosition ^ mask;
-    uint64_t cur_pieces = currentPosition;
+    Bitboard opp_pieces = currentPosition ^ mask;
+    Bitboard cur_pieces = currentPosition;
 
     // The old, naive pattern counting (no live-threat detection)
     int cur_score = 0;
     int opp_score = 0;
-    cur_score += (int)__popcnt64(cur_pieces & (cur_pieces >> 7)) * 2;
-    opp_score += (int)__popcnt64(opp_pieces & (opp_pieces >> 7)) * 2;
-    cur_score += (int)__popcnt64(cur_pieces & (cur_pieces >> 1)) * 2;
-    opp_score += (int)__popcnt64(opp_pieces & (opp_pieces >> 1)) * 2;
+    cur_score += bitCount(cur_pieces & (cur_pieces >> STRIDE)) * 2;
+    opp_score += bitCount(opp_pieces & (opp_pieces >> STRIDE)) * 2;
+    cur_score += bitCount(cur_pieces & (cur_pieces >> 1)) * 2;
+    opp_score += bitCount(opp_pieces & (opp_pieces >> 1)) * 2;
 
     // The old simple center bias
-    uint64_t centerMask = 0x3FULL << 21;
-    cur_score += (int)__popcnt64(cur_pieces & centerMask) * 3;
-    opp_score += (int)__popcnt64(opp_pieces & centerMask) * 3;
+    cur_score += bitCount(cur_pieces & CENTER_MASK<W, H>) * 3;
+    opp_score += bitCount(opp_pieces & CENTER_MASK<W, H>) * 3;
 
     return cur_score - opp_score;
 }
 
 // displays the board
-void Board::displayBoard() const
+template <int W, int H>
+void BasicBoard<W, H>::displayBoard() const
 {
-    std::cout << BLUE << "\n  0   1   2   3   4   5   6\n"
-              << RESET;
-    std::cout << BLUE << "-----------------------------\n"
+    std::string border(4 * W + 1, '-');
+    std::cout << BLUE << "\n";
+    for (int col = 0; col < W; col++)
+    {
+        std::cout << "  " << col << " ";
+    }
+    std::cout << "\n"
+              << border << "\n"
               << RESET;
 
-    // Start from the top row (5) and go down to the bottom row (0)
-    for (int row = 5; row >= 0; row--)
+    // Start from the top row (H - 1) and go down to the bottom row (0)
+    for (int row = H - 1; row >= 0; row--)
     {
         std::cout << BLUE << "|" << RESET;
-        for (int col = 0; col < 7; col++)
+        for (int col = 0; col < W; col++)
         {
-            int bitIndex = row + col * 7;
-            uint64_t bit = 1ULL << bitIndex;
+            int bitIndex = row + col * STRIDE;
+            Bitboard bit = (Bitboard)1 << bitIndex;
 
             if ((mask & bit) == 0)
             {
@@ -290,40 +457,75 @@ void Board::displayBoard() const
                     std::cout << " " << YELLOW << "O" << RESET << BLUE << " |" << RESET; // AI (Yellow)
             }
         }
-        std::cout << BLUE << "\n-----------------------------\n"
+        std::cout << BLUE << "\n"
+                  << border << "\n"
                   << RESET;
     }
     std::cout << "\n";
 }
 
 // mirrors the board
-uint64_t Board::mirror(uint64_t key) const
+template <int W, int H>
+typename BasicBoard<W, H>::Bitboard BasicBoard<W, H>::mirror(Bitboard key) const
 {
-    return ((key & 0x000000000000007FULL) << 42) | // Move Col 0 to Col 6
-           ((key & 0x0000000000003F80ULL) << 28) | // Move Col 1 to Col 5
-           ((key & 0x00000000001FC000ULL) << 14) | // Move Col 2 to Col 4
-           ((key & 0x000000000FE00000ULL)) |       // Keep Col 3 in the middle
-           ((key & 0x00000007F0000000ULL) >> 14) | // Move Col 4 to Col 2
-           ((key & 0x000003F800000000ULL) >> 28) | // Move Col 5 to Col 1
-           ((key & 0x0001FC0000000000ULL) >> 42);  // Move Col 6 to Col 0
+    // Moves column c to column W - 1 - c; the loop is unrolled into shifts and masks
+    const Bitboard column = ((Bitboard)1 << STRIDE) - 1;
+    Bitboard mirrored = 0;
+    for (int col = 0; col < W; col++)
+    {
+        mirrored |= ((key >> (col * STRIDE)) & column) << ((W - 1 - col) * STRIDE);
+    }
+    return mirrored;
 }
 
-// gets the hash of the board for the transposition table
-uint64_t Board::hash(bool &isMirror) const
+/* gets the unique ID of the board. Adding the mask to the current player's
+pieces sets the bit just above each column's top piece, so every position
+maps to a different number that fits in KEY_BITS bits (49 on a 7x6 board). */
+template <int W, int H>
+typename BasicBoard<W, H>::Bitboard BasicBoard<W, H>::key() const
 {
-    // Start with your unique board ID
-    uint64_t baseKey = currentPosition + mask;
-    uint64_t mirrorKey = mirror(baseKey);
+    return currentPosition + mask;
+}
+
+// gets the key of whichever of the board and its mirror image is smaller
+template <int W, int H>
+typename BasicBoard<W, H>::Bitboard BasicBoard<W, H>::canonicalKey(bool &isMirror) const
+{
+    Bitboard baseKey = key();
+    Bitboard mirrorKey = mirror(baseKey);
 
     isMirror = mirrorKey < baseKey; // Determine if the mirrored version is "smaller" for symmetry reduction
-    uint64_t key = isMirror ? mirrorKey : baseKey;
+    return isMirror ? mirrorKey : baseKey;
+}
 
-    // Use a bit-mixing function to spread the bits around and reduce collisions
+// mixes the bits of a key so that similar keys get unrelated hashes
+static inline uint64_t mixKey(uint64_t key)
+{
     key ^= key >> 30;
     key *= 0xbf58476d1ce4e5b9ULL;
     key ^= key >> 27;
     key *= 0x94d049bb133111ebULL;
     key ^= key >> 31;
-
     return key;
 }
+
+#ifdef C4_WIDE_BITBOARD
+/* Keys over 64 bits are folded into one word. Unlike on smaller boards,
+two positions can then share a hash, which the transposition table
+already tolerates as an ordinary collision. */
+static inline uint64_t mixKey(uint128_bits key)
+{
+    return mixKey((uint64_t)key ^ mixKey((uint64_t)(key >> 64)));
+}
+#endif
+
+// gets the hash of the board for the transposition table
+template <int W, int H>
+uint64_t BasicBoard<W, H>::hash(bool &isMirror) const
+{
+    // Start with your unique board ID and use a bit-mixing function to
+    // spread the bits around and reduce collisions
+    return mixKey(canonicalKey(isMirror));
+}
+
+template class BasicBoard<C4_WIDTH, C4_HEIGHT>;
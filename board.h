@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <type_traits>
 
 /*
 
@@ -16,32 +17,106 @@ Board Representation using bitborads:
  0 0 0 0 0 0 0  (ghost row)
 ---------------
 
-Shift by 7 to the left to move left a column.
+Shift by STRIDE (H + 1, 7 on the standard board) to the left to move
+left a column.
 
 Column-major ordering. The bottom row is the least significant
 bits, and the top row is the most significant bits. The ghost row
 is used to detect wins without needing to check for out-of-bounds
 conditions.
 
+The board is a template over its width and height, so every mask and
+shift is a compile-time constant. The engine is built for one size,
+7x6 unless C4_WIDTH / C4_HEIGHT say otherwise, e.g.
+
+  g++ -O3 -DC4_WIDTH=6 -DC4_HEIGHT=5 ...
+
+Boards of up to 64 bits (W * (H + 1), e.g. 8x7) use uint64_t bitboards.
+Larger ones such as 9x7 need unsigned __int128, so they only build with
+g++ or clang.
+
 */
 
-class Board
+#ifndef C4_WIDTH
+#define C4_WIDTH 7
+#endif
+#ifndef C4_HEIGHT
+#define C4_HEIGHT 6
+#endif
+
+#if C4_WIDTH * (C4_HEIGHT + 1) > 64
+#define C4_WIDE_BITBOARD 1
+#endif
+
+#if defined(__SIZEOF_INT128__)
+typedef unsigned __int128 uint128_bits;
+#else
+struct uint128_bits; // incomplete: boards over 64 bits are not supported by this compiler
+#endif
+
+template <int W, int H>
+class BasicBoard
 {
+public:
+    static constexpr int WIDTH = W;
+    static constexpr int HEIGHT = H;
+    static constexpr int CELLS = W * H;
+    static constexpr int STRIDE = H + 1;       // bits per column, including the ghost row
+    static constexpr int KEY_BITS = W * STRIDE; // bits used by key()
+
+    static_assert(W >= 4 && H >= 4, "four in a row needs at least a 4x4 board");
+    static_assert(KEY_BITS <= 128, "boards are limited to 128 bits");
+
+    typedef typename std::conditional<KEY_BITS <= 64, uint64_t, uint128_bits>::type Bitboard;
+
 private:
-    uint64_t mask;                         // 1 where ever there is a piece
-    uint64_t currentPosition;              // 1 where there is a piece of the current player
+    Bitboard mask;                         // 1 where ever there is a piece
+    Bitboard currentPosition;              // 1 where there is a piece of the current player
     int numberMoves;                       // determines current player, and optimize win checking
-    int countPatterns(uint64_t pos) const; // helper function for score evaluation
-    uint64_t mirror(uint64_t key) const;   // helper function for symmetry reduction in transposition table
+    int positionalScore;                   // per-disc terms of score(), player 1 minus player 2, kept up to date by makeMove
+    int countPatterns(Bitboard pos) const; // helper function for score evaluation
+    Bitboard mirror(Bitboard key) const;   // helper function for symmetry reduction in transposition table
+    static Bitboard winningCells(Bitboard pos, Bitboard occupied); // empty cells that would complete four for pos
+
+    // bottom cell of every column
+    static constexpr Bitboard bottomMask()
+    {
+        Bitboard bottom = 0;
+        for (int col = 0; col < W; col++)
+        {
+            bottom |= Bitboard(1) << (col * STRIDE);
+        }
+        return bottom;
+    }
+
+    static constexpr Bitboard BOTTOM_MASK = bottomMask();
+    static constexpr Bitboard COLUMN_CELLS = (Bitboard(1) << H) - 1;  // playable cells of column 0
+    static constexpr Bitboard BOARD_MASK = BOTTOM_MASK * COLUMN_CELLS; // every playable cell (no ghost row)
 
 public:
-    Board() : mask(0ULL), currentPosition(0ULL), numberMoves(0) {}
+    BasicBoard() : mask(0), currentPosition(0), numberMoves(0), positionalScore(0) {}
     int numMoves() const;
     bool checkMove(int columnNumber) const;
     bool makeMove(const int columnNumber);
     bool checkWin() const;
     int score() const;
+    int incrementalScore() const; // same value as score(), reusing the per-disc terms makeMove maintains
+    static void scoreBatch(const BasicBoard *boards, int count, int *scores); // incrementalScore() of several boards, SIMD when available
     int oldScore() const; // old, naive score function for testing purposes
     void displayBoard() const;
+    // Threat detection (one bit per cell, same layout as the bitboards)
+    static Bitboard columnMask(int columnNumber);
+    Bitboard possible() const;                 // cells a move can be played in right now
+    Bitboard winningPositions() const;         // empty cells that would win for the player to move
+    Bitboard opponentWinningPositions() const; // empty cells that would win for the other player
+    bool canWinNext() const;                   // player to move has a winning move
+    Bitboard possibleNonLosingMoves() const;   // moves that do not hand the opponent a win next turn
+    int threatsAfterMove(int columnNumber) const; // winning cells the player to move has after playing a column
+
+    Bitboard key() const;                        // unique position key (KEY_BITS bits)
+    Bitboard canonicalKey(bool &isMirror) const; // smaller of the key and its mirror image
     uint64_t hash(bool &isMirror) const;
 };
+
+// the board the engine is built for
+typedef BasicBoard<C4_WIDTH, C4_HEIGHT> Board;
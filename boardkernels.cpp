@@ -0,0 +1,204 @@
+#include "boardkernels.h"
+#include "platform.h"
+
+#ifdef C4_X86_64
+#include <immintrin.h>
+#endif
+
+/* Target regions: every function defined between a BEGIN and C4_TARGET_END
+may use the named instruction set, whatever the rest of the build targets.
+MSVC needs no region, it accepts any intrinsic in any function. */
+#if defined(C4_X86_64) && defined(__clang__)
+#define C4_TARGET_BEGIN_POPCNT _Pragma("clang attribute push(__attribute__((target(\"popcnt\"))), apply_to = function)")
+#define C4_TARGET_BEGIN_AVX2 _Pragma("clang attribute push(__attribute__((target(\"avx2,popcnt\"))), apply_to = function)")
+#define C4_TARGET_BEGIN_AVX512 _Pragma("clang attribute push(__attribute__((target(\"avx512f,avx512vpopcntdq,avx2,popcnt\"))), apply_to = function)")
+#define C4_TARGET_END _Pragma("clang attribute pop")
+#elif defined(C4_X86_64) && defined(__GNUC__)
+#define C4_TARGET_BEGIN_POPCNT _Pragma("GCC push_options") _Pragma("GCC target(\"popcnt\")")
+#define C4_TARGET_BEGIN_AVX2 _Pragma("GCC push_options") _Pragma("GCC target(\"avx2,popcnt\")")
+#define C4_TARGET_BEGIN_AVX512 _Pragma("GCC push_options") _Pragma("GCC target(\"avx512f,avx512vpopcntdq,avx2,popcnt\")")
+#define C4_TARGET_END _Pragma("GCC pop_options")
+#else
+#define C4_TARGET_BEGIN_POPCNT
+#define C4_TARGET_BEGIN_AVX2
+#define C4_TARGET_BEGIN_AVX512
+#define C4_TARGET_END
+#endif
+
+// the POPCNT instruction, for regions that may use it
+#if defined(_MSC_VER)
+#define C4_HARDWARE_POPCOUNT(x) __popcnt64(x)
+#else
+#define C4_HARDWARE_POPCOUNT(x) __builtin_popcountll(x)
+#endif
+
+// --- Baseline: plain 64-bit code, bit-trick popcount unless the build enables POPCNT ---
+namespace baseline
+{
+static inline uint64_t popcount(uint64_t x)
+{
+    return (uint64_t)popcount64(x);
+}
+#define C4_KERNEL_NAME "baseline"
+#include "patterns.inc"
+#undef C4_KERNEL_NAME
+}
+
+#ifdef C4_X86_64
+
+// --- POPCNT: same code, hardware popcount ---
+C4_TARGET_BEGIN_POPCNT
+namespace popcnt
+{
+static inline uint64_t popcount(uint64_t x)
+{
+    return (uint64_t)C4_HARDWARE_POPCOUNT(x);
+}
+#define C4_KERNEL_NAME "popcnt"
+#include "patterns.inc"
+#undef C4_KERNEL_NAME
+}
+C4_TARGET_END
+
+/* SIMD lane types. Each holds one 64-bit bitboard per lane and supports
+exactly the operations patternScore uses, so the same pattern code runs
+on 4 (AVX2) or 8 (AVX-512) boards at once. */
+
+// --- AVX2: 4 boards per batch ---
+C4_TARGET_BEGIN_AVX2
+namespace avx2
+{
+static inline uint64_t popcount(uint64_t x)
+{
+    return (uint64_t)C4_HARDWARE_POPCOUNT(x);
+}
+
+struct Lanes
+{
+    static const int COUNT = 4;
+    __m256i v;
+    Lanes(__m256i x) : v(x) {}
+    Lanes(uint64_t x) : v(_mm256_set1_epi64x((long long)x)) {}
+    static Lanes load(const uint64_t *p) { return _mm256_loadu_si256((const __m256i *)p); }
+    void store(uint64_t *p) const { _mm256_storeu_si256((__m256i *)p, v); }
+};
+static inline Lanes operator&(Lanes a, Lanes b) { return _mm256_and_si256(a.v, b.v); }
+static inline Lanes operator|(Lanes a, Lanes b) { return _mm256_or_si256(a.v, b.v); }
+static inline Lanes &operator|=(Lanes &a, Lanes b) { return a = a | b; }
+static inline Lanes operator~(Lanes a) { return _mm256_xor_si256(a.v, _mm256_set1_epi64x(-1)); }
+static inline Lanes operator>>(Lanes a, unsigned n) { return _mm256_srli_epi64(a.v, n); }
+static inline Lanes operator+(Lanes a, Lanes b) { return _mm256_add_epi64(a.v, b.v); }
+static inline Lanes operator-(Lanes a, Lanes b) { return _mm256_sub_epi64(a.v, b.v); }
+static inline Lanes operator*(Lanes a, uint64_t k) { return _mm256_mul_epu32(a.v, _mm256_set1_epi64x((long long)k)); } // lanes < 2^32
+
+// AVX2 has no 64-bit popcount: count nibbles with a lookup shuffle, then sum the bytes of each lane
+static inline Lanes popcount(Lanes a)
+{
+    const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                           0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low = _mm256_set1_epi8(0x0F);
+    __m256i counts = _mm256_add_epi8(_mm256_shuffle_epi8(table, _mm256_and_si256(a.v, low)),
+                                     _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(a.v, 4), low)));
+    return _mm256_sad_epu8(counts, _mm256_setzero_si256());
+}
+
+#define C4_KERNEL_NAME "avx2"
+#ifndef C4_WIDE_BITBOARD
+#define C4_KERNEL_LANES
+#endif
+#include "patterns.inc"
+#undef C4_KERNEL_LANES
+#undef C4_KERNEL_NAME
+}
+C4_TARGET_END
+
+// --- AVX-512: 8 boards per batch, native 64-bit popcount ---
+C4_TARGET_BEGIN_AVX512
+namespace avx512
+{
+static inline uint64_t popcount(uint64_t x)
+{
+    return (uint64_t)C4_HARDWARE_POPCOUNT(x);
+}
+
+// The zero-masked forms avoid GCC warnings about the unmasked forms' undefined pass-through operand
+struct Lanes
+{
+    static const int COUNT = 8;
+    __m512i v;
+    Lanes(__m512i x) : v(x) {}
+    Lanes(uint64_t x) : v(_mm512_set1_epi64((long long)x)) {}
+    static Lanes load(const uint64_t *p) { return _mm512_loadu_si512(p); }
+    void store(uint64_t *p) const { _mm512_storeu_si512(p, v); }
+};
+static inline Lanes operator&(Lanes a, Lanes b) { return _mm512_and_si512(a.v, b.v); }
+static inline Lanes operator|(Lanes a, Lanes b) { return _mm512_or_si512(a.v, b.v); }
+static inline Lanes &operator|=(Lanes &a, Lanes b) { return a = a | b; }
+static inline Lanes operator~(Lanes a) { return _mm512_xor_si512(a.v, _mm512_set1_epi64(-1)); }
+static inline Lanes operator>>(Lanes a, unsigned n) { return _mm512_maskz_srli_epi64(0xFF, a.v, n); }
+static inline Lanes operator+(Lanes a, Lanes b) { return _mm512_add_epi64(a.v, b.v); }
+static inline Lanes operator-(Lanes a, Lanes b) { return _mm512_sub_epi64(a.v, b.v); }
+static inline Lanes operator*(Lanes a, uint64_t k) { return _mm512_maskz_mul_epu32(0xFF, a.v, _mm512_set1_epi64((long long)k)); } // lanes < 2^32
+static inline Lanes popcount(Lanes a) { return _mm512_popcnt_epi64(a.v); }
+
+#define C4_KERNEL_NAME "avx512"
+#ifndef C4_WIDE_BITBOARD
+#define C4_KERNEL_LANES
+#endif
+#include "patterns.inc"
+#undef C4_KERNEL_LANES
+#undef C4_KERNEL_NAME
+}
+C4_TARGET_END
+
+#endif
+
+// the fastest kernels the running CPU supports
+static const BoardKernels *bestKernels()
+{
+#ifdef C4_X86_64
+    const CpuFeatures &cpu = cpuFeatures();
+    if (cpu.avx512)
+    {
+        return &avx512::kernels;
+    }
+    if (cpu.avx2 && cpu.popcnt)
+    {
+        return &avx2::kernels;
+    }
+    if (cpu.popcnt)
+    {
+        return &popcnt::kernels;
+    }
+#endif
+    return &baseline::kernels;
+}
+
+const BoardKernels *boardKernels = bestKernels();
+
+bool selectBoardKernels(const std::string &name)
+{
+    // Lowest level first, so no level past the best supported one is ever chosen
+    const BoardKernels *levels[] = {
+        &baseline::kernels,
+#ifdef C4_X86_64
+        &popcnt::kernels,
+        &avx2::kernels,
+        &avx512::kernels,
+#endif
+    };
+    const BoardKernels *best = bestKernels();
+    for (const BoardKernels *level : levels)
+    {
+        if (name == level->name)
+        {
+            boardKernels = level;
+            return true;
+        }
+        if (level == best)
+        {
+            break;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "board.h"
+#include <cstdint>
+#include <string>
+
+/*
+
+The evaluation kernels behind Board::score, compiled once per
+instruction set level:
+
+  baseline  any x86-64 (or non-x86) CPU
+  popcnt    hardware POPCNT
+  avx2      POPCNT plus 4 boards per batch in AVX2 registers
+  avx512    8 boards per batch with AVX-512 VPOPCNTDQ
+
+The fastest level the CPU supports is chosen from CPUID at startup, so
+one binary runs at full speed on every machine. The batch kernels need
+64-bit bitboards; on larger boards every level scores one board at a time.
+checkWin, hash and mirror are not dispatched: they are a handful of
+shifts and multiplies with no instruction-set-specific form, and an
+indirect call would cost more than the functions themselves.
+
+*/
+
+struct BoardKernels
+{
+    const char *name;
+
+    // pattern term of score() for pos on a board whose occupied cells are mask
+    int (*countPatterns)(Board::Bitboard pos, Board::Bitboard mask);
+
+    /* countPatterns(current) - countPatterns(opponent) for several boards
+    given as (current player's stones, occupied cells) pairs */
+    void (*patternBalance)(const Board::Bitboard *current, const Board::Bitboard *mask, int count, int *out);
+};
+
+// kernels in use, the best supported level unless overridden
+extern const BoardKernels *boardKernels;
+
+// forces a level by name (for testing and comparisons), false if unknown or unsupported
+bool selectBoardKernels(const std::string &name);
@@ -0,0 +1,432 @@
+#include "book.h"
+#include <algorithm> // sort, lower_bound
+#include <cstdio>    // rename, remove
+#include <cstring>
+#include <filesystem> // resize_file
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h> // _commit
+#else
+#include <unistd.h> // fsync
+#endif
+
+/* Reverses the bit mixer at the end of Board::hash. Each step of the
+mixer (xor-shift, multiply by an odd constant) is a bijection, so undoing
+them in reverse order gives back the canonical key. */
+static uint64_t unmixHash(uint64_t key)
+{
+    key ^= (key >> 31) ^ (key >> 62);
+    key *= 0x319642b2d24d8ec3ULL; // inverse of 0x94d049bb133111eb
+    key ^= (key >> 27) ^ (key >> 54);
+    key *= 0x96de1b173f119089ULL; // inverse of 0xbf58476d1ce4e5b9
+    key ^= (key >> 30) ^ (key >> 60);
+    return key;
+}
+
+/* Works out how many pieces are on the board described by a key, or -1
+if the number cannot be a real key. Each STRIDE-bit column holds its pieces
+plus the marker bit above the top piece, so a column with h pieces has a
+value in [2^h - 1, 2^(h+1) - 2]. */
+static int keyPly(uint64_t key)
+{
+    if (Board::KEY_BITS < 64 && (key >> (Board::KEY_BITS % 64)))
+    {
+        return -1;
+    }
+
+    int ply = 0;
+    int currentPieces = 0; // pieces of the player to move
+    const uint64_t full = (1ULL << Board::STRIDE) - 1;
+    for (int col = 0; col < Board::WIDTH; col++)
+    {
+        uint64_t column = (key >> (col * Board::STRIDE)) & full;
+        if (column == full)
+        {
+            return -1;
+        }
+
+        int height = 0;
+        while (column >= (2ULL << height) - 1)
+        {
+            height++;
+        }
+        ply += height;
+
+        for (uint64_t pieces = column - ((1ULL << height) - 1); pieces; pieces &= pieces - 1)
+        {
+            currentPieces++;
+        }
+    }
+
+    // The player to move has placed exactly half of the pieces (rounded down)
+    return currentPieces == ply / 2 ? ply : -1;
+}
+
+static_assert(sizeof(BookEntry) == 16, "book entries are 16 bytes on disk");
+
+// orders entries by key, for sorting and binary search
+static bool keyLess(const BookEntry &entry, uint64_t key)
+{
+    return entry.key < key;
+}
+
+OpeningBook::OpeningBook() : entries(nullptr), packed(nullptr), count(0), deepestPly(0)
+{
+}
+
+OpeningBook::~OpeningBook()
+{
+    close();
+}
+
+// maps a version 3 (or 2) book file into memory, no entries are copied
+bool OpeningBook::open(const std::string &path)
+{
+    close();
+    if (!file.open(path))
+    {
+        return false;
+    }
+
+    // Validate the header before trusting any of the entries
+    const BookHeader *header = (const BookHeader *)file.data();
+    if (file.size() < sizeof(BookHeader))
+    {
+        close();
+        return false;
+    }
+    size_t entrySize = header->version == 2 ? sizeof(uint64_t) : sizeof(BookEntry);
+    if (std::memcmp(header->magic, "C4BK", 4) != 0 ||
+        (header->version != VERSION && header->version != 2) ||
+        header->width != Board::WIDTH || header->height != Board::HEIGHT ||
+        file.size() != sizeof(BookHeader) + header->count * entrySize)
+    {
+        close();
+        return false;
+    }
+
+    const char *data = file.data() + sizeof(BookHeader);
+    if (header->version == 2)
+    {
+        packed = (const uint64_t *)data;
+    }
+    else
+    {
+        entries = (const BookEntry *)data;
+    }
+    count = (size_t)header->count;
+    deepestPly = (int)header->maxPly;
+    return true;
+}
+
+// unmaps the book file
+void OpeningBook::close()
+{
+    file.close();
+    entries = nullptr;
+    packed = nullptr;
+    count = 0;
+    deepestPly = 0;
+}
+
+bool OpeningBook::isOpen() const
+{
+    return entries != nullptr || packed != nullptr;
+}
+
+size_t OpeningBook::size() const
+{
+    return count;
+}
+
+int OpeningBook::maxPly() const
+{
+    return deepestPly;
+}
+
+// looks up a canonical position key
+bool OpeningBook::probe(uint64_t canonicalKey, BookEntry &entry) const
+{
+    if (entries)
+    {
+        const BookEntry *it = std::lower_bound(entries, entries + count, canonicalKey, keyLess);
+        if (it == entries + count || it->key != canonicalKey)
+        {
+            return false;
+        }
+        entry = *it;
+        return true;
+    }
+
+    if (!packed)
+    {
+        return false;
+    }
+
+    // The smallest packed value with this key is key << PAYLOAD_BITS
+    uint64_t target = canonicalKey << PAYLOAD_BITS;
+    const uint64_t *it = std::lower_bound(packed, packed + count, target);
+
+    if (it == packed + count || (*it >> PAYLOAD_BITS) != canonicalKey)
+    {
+        return false;
+    }
+
+    entry = moveOnly(canonicalKey, (int)(*it & 0xFF));
+    return true;
+}
+
+// looks up the best move for a canonical position key
+bool OpeningBook::probe(uint64_t canonicalKey, int &move) const
+{
+    BookEntry entry;
+    if (!probe(canonicalKey, entry))
+    {
+        return false;
+    }
+    move = entry.move;
+    return true;
+}
+
+// copies every entry into a hash map (used to resume book generation)
+void OpeningBook::copyTo(std::unordered_map<uint64_t, BookEntry> &out) const
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        if (entries)
+        {
+            out[entries[i].key] = entries[i];
+        }
+        else
+        {
+            out[packed[i] >> PAYLOAD_BITS] = moveOnly(packed[i] >> PAYLOAD_BITS, (int)(packed[i] & 0xFF));
+        }
+    }
+}
+
+// an entry that knows the best move but no score
+BookEntry OpeningBook::moveOnly(uint64_t canonicalKey, int move)
+{
+    BookEntry entry;
+    std::memset(&entry, 0, sizeof(entry));
+    entry.key = canonicalKey;
+    entry.move = (uint8_t)move;
+    entry.bound = BOUND_NONE;
+    return entry;
+}
+
+// sorts the entries and writes a version 3 book file
+bool OpeningBook::write(const std::string &path, const std::unordered_map<uint64_t, BookEntry> &bookEntries)
+{
+    std::vector<BookEntry> sorted;
+    sorted.reserve(bookEntries.size());
+
+    BookHeader header;
+    std::memcpy(header.magic, "C4BK", 4);
+    header.version = VERSION;
+    header.width = Board::WIDTH;
+    header.height = Board::HEIGHT;
+    header.maxPly = 0;
+    header.reserved = 0;
+
+    for (const auto &pair : bookEntries)
+    {
+        int ply = keyPly(pair.first);
+        if (ply < 0)
+        {
+            continue; // never write a key that cannot be a real position
+        }
+        header.maxPly = std::max(header.maxPly, (uint32_t)ply);
+        sorted.push_back(pair.second);
+        sorted.back().key = pair.first;
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const BookEntry &a, const BookEntry &b)
+              { return a.key < b.key; });
+    header.count = sorted.size();
+
+    /* Write to a temporary file and rename it over the old book, so a crash
+    never leaves a truncated book and processes that still have the old file
+    mapped keep reading the old copy. */
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream outFile(tempPath, std::ios::binary | std::ios::trunc);
+        if (!outFile.is_open())
+        {
+            return false;
+        }
+        outFile.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        outFile.write(reinterpret_cast<const char *>(sorted.data()), sorted.size() * sizeof(BookEntry));
+        if (!outFile)
+        {
+            return false;
+        }
+    }
+
+#ifdef _WIN32
+    std::remove(path.c_str()); // rename does not replace existing files on Windows
+#endif
+    return std::rename(tempPath.c_str(), path.c_str()) == 0;
+}
+
+// checks whether a file is a headerless version 1 book
+bool OpeningBook::isLegacyFile(const std::string &path)
+{
+    std::ifstream inFile(path, std::ios::binary | std::ios::ate);
+    if (!inFile.is_open())
+    {
+        return false;
+    }
+
+    std::streamoff size = inFile.tellg();
+    char magic[4] = {0, 0, 0, 0};
+    inFile.seekg(0);
+    inFile.read(magic, 4);
+    return size > 0 && size % 9 == 0 && std::memcmp(magic, "C4BK", 4) != 0;
+}
+
+// converts a version 1 book (mixed hash + move records) to version 3, without scores
+bool OpeningBook::convertLegacy(const std::string &legacyPath, const std::string &path)
+{
+    std::ifstream inFile(legacyPath, std::ios::binary);
+    if (!inFile.is_open())
+    {
+        std::cerr << "Could not open " << legacyPath << "\n";
+        return false;
+    }
+
+    std::unordered_map<uint64_t, BookEntry> moves;
+    uint64_t hash;
+    uint8_t move;
+    size_t rejected = 0;
+
+    while (inFile.read(reinterpret_cast<char *>(&hash), sizeof(hash)) &&
+           inFile.read(reinterpret_cast<char *>(&move), sizeof(move)))
+    {
+        uint64_t key = unmixHash(hash);
+        if (keyPly(key) < 0 || move >= Board::WIDTH)
+        {
+            rejected++; // not a hash of any real position
+            continue;
+        }
+        moves[key] = moveOnly(key, move);
+    }
+
+    std::cout << "Converted " << moves.size() << " positions";
+    if (rejected)
+    {
+        std::cout << " (" << rejected << " invalid records dropped)";
+    }
+    std::cout << ".\n";
+
+    return write(path, moves);
+}
+
+BookLog::BookLog() : file(nullptr)
+{
+}
+
+BookLog::~BookLog()
+{
+    close();
+}
+
+/* Opens the log at path for appending, creating it if needed. Entries of
+an existing log are added to moves; a torn or corrupt tail is cut off so
+new entries line up again. Fails on a log written for another board size. */
+bool BookLog::open(const std::string &path, std::unordered_map<uint64_t, BookEntry> &entries)
+{
+    close();
+
+    BookHeader header;
+    std::memset(&header, 0, sizeof(header));
+    uint64_t validBytes = 0;
+    {
+        std::ifstream inFile(path, std::ios::binary);
+        if (inFile.is_open() && inFile.read(reinterpret_cast<char *>(&header), sizeof(header)))
+        {
+            if (std::memcmp(header.magic, "C4BL", 4) != 0 || header.version != OpeningBook::VERSION ||
+                header.width != (uint32_t)Board::WIDTH || header.height != (uint32_t)Board::HEIGHT)
+            {
+                std::cerr << path << " is not a version " << OpeningBook::VERSION << " book log for a "
+                          << Board::WIDTH << "x" << Board::HEIGHT << " board\n";
+                return false;
+            }
+            validBytes = sizeof(header);
+
+            BookEntry entry;
+            while (inFile.read(reinterpret_cast<char *>(&entry), sizeof(entry)))
+            {
+                if (keyPly(entry.key) < 0 || entry.move >= Board::WIDTH || entry.bound > OpeningBook::BOUND_NONE)
+                {
+                    break; // garbage from a crash, everything before it is good
+                }
+                entries[entry.key] = entry;
+                validBytes += sizeof(entry);
+            }
+        }
+    }
+
+    if (validBytes == 0)
+    {
+        // New log (or one that died before its header was complete)
+        file = std::fopen(path.c_str(), "wb");
+        if (!file)
+        {
+            return false;
+        }
+        std::memcpy(header.magic, "C4BL", 4);
+        header.version = OpeningBook::VERSION;
+        header.width = Board::WIDTH;
+        header.height = Board::HEIGHT;
+        header.maxPly = 0;
+        header.reserved = 0;
+        header.count = 0;
+        if (std::fwrite(&header, sizeof(header), 1, file) != 1 || std::fflush(file) != 0)
+        {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    std::error_code error;
+    std::filesystem::resize_file(path, validBytes, error);
+    if (error)
+    {
+        return false;
+    }
+    file = std::fopen(path.c_str(), "ab");
+    return file != nullptr;
+}
+
+// appends entries and pushes them to disk, so they survive the process dying
+bool BookLog::append(const std::vector<BookEntry> &entries)
+{
+    if (!file)
+    {
+        return false;
+    }
+
+    if (std::fwrite(entries.data(), sizeof(BookEntry), entries.size(), file) != entries.size() || std::fflush(file) != 0)
+    {
+        return false;
+    }
+#ifdef _WIN32
+    _commit(_fileno(file));
+#else
+    fsync(fileno(file));
+#endif
+    return true;
+}
+
+void BookLog::close()
+{
+    if (file)
+    {
+        std::fclose(file);
+        file = nullptr;
+    }
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "board.h"
+#include "platform.h"
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+
+Opening book file format (version 3):
+
+  BookHeader (32 bytes)
+  BookEntry entries[count]  sorted by key
+
+Each 16-byte entry holds a canonical position key (Board::canonicalKey,
+49 bits on the standard board) with the best move for the canonical side
+and the score the generator's search gave the position: its bound (the
+transposition table's exact / lower / upper flags) and how many plies
+deep it was searched. Scores are on negamax's scale, for the side to
+move, so Searcher::negamax can use an entry inside the book's ply range
+like a transposition table hit.
+
+Version 2 books (a uint64_t per entry: key << 8 | move, no score) are
+still read; their entries only ever answer at the root.
+
+The header records the board size, so a book only opens in an engine
+built for the same size. Boards whose keys take more than 64 bits (9x7
+and larger) cannot have a book.
+
+Because the entries are sorted by key, the file is memory-mapped and
+binary searched in place. Nothing is parsed at start-up and the pages
+are shared between every process that opens the same book. Storing the
+real key instead of a hash means a hit is always the exact position.
+
+The legacy (version 1) file is a headerless list of 9-byte records of
+mixed hash + move in hash-map order. Board::hash is an invertible mixer,
+so convertLegacy recovers the canonical keys from those hashes.
+
+*/
+
+struct BookHeader
+{
+    char magic[4];      // "C4BK"
+    uint32_t version;   // 3 (2 is still read)
+    uint32_t width;     // board columns
+    uint32_t height;    // board rows
+    uint32_t maxPly;    // deepest position stored
+    uint32_t reserved;  // zero
+    uint64_t count;     // number of entries
+};
+
+struct BookEntry
+{
+    uint64_t key;        // canonical position key
+    int16_t score;       // for the side to move, meaningless if bound is BOUND_NONE
+    uint8_t move;        // best move for the canonical position
+    uint8_t bound;       // OpeningBook::BOUND_*
+    uint8_t depth;       // plies the score was searched to
+    uint8_t reserved[3]; // zero
+};
+
+class OpeningBook
+{
+private:
+    const BookEntry *entries; // version 3, points into the mapping, sorted by key
+    const uint64_t *packed;   // version 2 instead, key << PAYLOAD_BITS | move
+    size_t count;
+    int deepestPly;
+
+    MappedFile file;
+
+public:
+    static const uint32_t VERSION = 3;
+    static const int PAYLOAD_BITS = 8; // move bits of a version 2 entry
+    static const bool SUPPORTED = Board::KEY_BITS <= 64; // keys of this board size fit an entry
+
+    // Score bounds, the same values as the transposition table's flags
+    static const uint8_t BOUND_EXACT = 0;
+    static const uint8_t BOUND_LOWER = 1;
+    static const uint8_t BOUND_UPPER = 2;
+    static const uint8_t BOUND_NONE = 3; // only a move (version 2 books, the empty board)
+
+    OpeningBook();
+    ~OpeningBook();
+    OpeningBook(const OpeningBook &) = delete;
+    OpeningBook &operator=(const OpeningBook &) = delete;
+
+    bool open(const std::string &path);
+    void close();
+    bool isOpen() const;
+    size_t size() const;
+    int maxPly() const;
+
+    bool probe(uint64_t canonicalKey, BookEntry &entry) const;
+    bool probe(uint64_t canonicalKey, int &move) const;
+    void copyTo(std::unordered_map<uint64_t, BookEntry> &out) const;
+
+    static BookEntry moveOnly(uint64_t canonicalKey, int move);
+    static bool write(const std::string &path, const std::unordered_map<uint64_t, BookEntry> &entries);
+    static bool convertLegacy(const std::string &legacyPath, const std::string &path);
+    static bool isLegacyFile(const std::string &path);
+};
+
+/*
+
+Book build log. While a book is generated, solved positions are appended
+to the log as version 3 entries, behind a BookHeader with magic "C4BL"
+(count unused). Appending and flushing a few entries is all a
+checkpoint costs, so generator threads never wait for the whole book to
+be rewritten. The book file is only written once, at the end, after which
+the log is deleted.
+
+An interrupted build leaves the log behind. open() replays it, cutting
+off anything after the last whole, valid entry (a write the crash tore),
+and the next build carries on appending to it.
+
+*/
+
+class BookLog
+{
+private:
+    std::FILE *file;
+
+public:
+    BookLog();
+    ~BookLog();
+    BookLog(const BookLog &) = delete;
+    BookLog &operator=(const BookLog &) = delete;
+
+    bool open(const std::string &path, std::unordered_map<uint64_t, BookEntry> &entries); // adds the logged entries
+    bool append(const std::vector<BookEntry> &entries);                                   // flushed to disk
+    void close();
+};
@@ -0,0 +1,277 @@
+#include "c4engine.h"
+#include "engine.h"
+#include "gamesession.h"
+#include <algorithm> // min
+#include <cstring>
+#include <new>       // bad_alloc
+#include <string>
+
+struct c4_engine
+{
+    Engine engine;
+};
+
+struct c4_session
+{
+    GameSession game;
+
+    explicit c4_session(Engine &engine) : game(engine) {}
+};
+
+// runs one API call, turning any exception into a status before it reaches the caller
+template <typename Body>
+static c4_status guarded(Body body)
+{
+    try
+    {
+        return body();
+    }
+    catch (const std::bad_alloc &)
+    {
+        return C4_OUT_OF_MEMORY;
+    }
+    catch (...)
+    {
+        return C4_INTERNAL_ERROR;
+    }
+}
+
+// sets up the session's board from a move history, the way handleServerRequest does
+static c4_status setPosition(c4_session *session, const char *history)
+{
+    if (!session->game.setPosition(history ? history : ""))
+    {
+        return C4_ILLEGAL_HISTORY;
+    }
+    if (session->game.isGameOver())
+    {
+        return C4_GAME_OVER;
+    }
+    if (history && std::strlen(history) >= (size_t)Board::CELLS)
+    {
+        return C4_BOARD_FULL;
+    }
+    return C4_OK;
+}
+
+int c4_api_version(void)
+{
+    return C4_API_VERSION;
+}
+
+const char *c4_status_message(c4_status status)
+{
+    switch (status)
+    {
+    case C4_OK:
+        return "ok";
+    case C4_ILLEGAL_HISTORY:
+        return "illegal move history";
+    case C4_BOARD_FULL:
+        return "board is full";
+    case C4_GAME_OVER:
+        return "game is over";
+    case C4_NOT_FOUND:
+        return "file not found";
+    case C4_INVALID_ARGUMENT:
+        return "invalid argument";
+    case C4_OUT_OF_MEMORY:
+        return "out of memory";
+    default:
+        return "internal error";
+    }
+}
+
+// creates an engine that prints nothing: the caller owns stdout
+c4_status c4_engine_create(c4_engine **engine)
+{
+    if (!engine)
+    {
+        return C4_INVALID_ARGUMENT;
+    }
+    *engine = nullptr;
+    return guarded([&]()
+                   {
+        c4_engine *created = new c4_engine();
+        created->engine.setVerbose(false);
+        *engine = created;
+        return C4_OK; });
+}
+
+void c4_engine_destroy(c4_engine *engine)
+{
+    delete engine;
+}
+
+c4_status c4_engine_load_book(c4_engine *engine, const char *path)
+{
+    if (!engine || !path)
+    {
+        return C4_INVALID_ARGUMENT;
+    }
+    return guarded([&]()
+                   { return engine->engine.loadOpeningBook(path) ? C4_OK : C4_NOT_FOUND; });
+}
+
+c4_status c4_engine_load_score_database(c4_engine *engine, const char *path)
+{
+    if (!engine || !path)
+    {
+        return C4_INVALID_ARGUMENT;
+    }
+    return guarded([&]()
+                   { return engine->engine.loadScoreDatabase(path) ? C4_OK : C4_NOT_FOUND; });
+}
+
+c4_status c4_engine_set_tt_size(c4_engine *engine, size_t megabytes)
+{
+    if (!engine)
+    {
+        return C4_INVALID_ARGUMENT;
+    }
+    return guarded([&]()
+                   {
+        engine->engine.setTranspositionTableSize(megabytes);
+        return C4_OK; });
+}
+
+c4_status c4_engine_set_threads(c4_engine *engine, int threads)
+{
+    if (!engine)
+    {
+        return C4_INVALID_ARGUMENT;
+    }
+    engine->engine.setThreads(threads);
+    return C4_OK;
+}
+
+c4_status c4_engine_set_limits(c4_engine *engine, int64_t move_time_ms, uint64_t max_nodes)
+{
+    if (!engine)
+    {
+        return C4_INVALID_ARGUMENT;
+    }
+    engine->engine.setLimits((long long)move_time_ms, max_nodes);
+    return C4_OK;
+}
+
+c4_status c4_engine_set_pondering(c4_engine *engine, int enabled)
+{
+    if (!engine)
+    {
+        return C4_INVALID_ARGUMENT;
+    }
+    engine->engine.setPondering(enabled != 0);
+    return C4_OK;
+}
+
+c4_status c4_session_create(c4_engine *engine, c4_session **session)
+{
+    if (!engine || !session)
+    {
+        return C4_INVALID_ARGUMENT;
+    }
+    *session = nullptr;
+    return guarded([&]()
+                   {
+        *session = new c4_session(engine->engine);
+        return C4_OK; });
+}
+
+// stops the session's ponder search, if any, before freeing it
+void c4_session_destroy(c4_session *session)
+{
+    delete session;
+}
+
+/* Picks the move for the position after history, as a --serve request
+would: book, score database or search. The session then plays the move
+and, with pondering on, searches the replies until its next call. */
+c4_status c4_session_solve(c4_session *session, const char *history, c4_result *result)
+{
+    if (!session || !result)
+    {
+        return C4_INVALID_ARGUMENT;
+    }
+    return guarded([&]()
+                   {
+        c4_status status = setPosition(session, history);
+        if (status != C4_OK)
+        {
+            return status;
+        }
+
+        GameSession &game = session->game;
+        int move = game.getAIMove(Board::CELLS, false);
+        result->move = move;
+        result->score = game.getLastScore();
+        result->book = game.wasBookMove() ? 1 : 0;
+        result->proven = game.wasProven() ? 1 : 0;
+        result->nodes = game.getNodesEvaluated();
+        result->time_ms = game.getLastSearchTime();
+
+        game.makeMove(move);
+        game.startPondering();
+        return C4_OK; });
+}
+
+// scores every legal move of the position after history, best first (GameSession::analyseMoves)
+c4_status c4_session_analyse(c4_session *session, const char *history, int exact_scores,
+                             c4_move_score *moves, int capacity, c4_analysis *analysis)
+{
+    if (!session || !analysis || (capacity > 0 && !moves))
+    {
+        return C4_INVALID_ARGUMENT;
+    }
+    return guarded([&]()
+                   {
+        c4_status status = setPosition(session, history);
+        if (status != C4_OK)
+        {
+            return status;
+        }
+
+        MoveAnalysis result = session->game.analyseMoves(exact_scores != 0);
+        analysis->count = std::min(capacity, (int)result.moves.size());
+        analysis->proven = result.proven ? 1 : 0;
+        analysis->nodes = result.nodes;
+        analysis->time_ms = result.timeMs;
+        for (int i = 0; i < analysis->count; i++)
+        {
+            const RootMove &scored = result.moves[i];
+            moves[i].move = scored.move;
+            moves[i].score = scored.score;
+            moves[i].bound = scored.bound == ScoreBound::Exact ? C4_BOUND_EXACT : (scored.bound == ScoreBound::Lower ? C4_BOUND_LOWER : C4_BOUND_UPPER);
+
+            size_t length = std::min(scored.pv.size(), sizeof(moves[i].pv) - 1);
+            for (size_t ply = 0; ply < length; ply++)
+            {
+                moves[i].pv[ply] = (char)('0' + scored.pv[ply]);
+            }
+            moves[i].pv[length] = '\0';
+        }
+        return C4_OK; });
+}
+
+size_t c4_session_stats_json(const c4_session *session, char *buffer, size_t size)
+{
+    if (!session)
+    {
+        return 0;
+    }
+    try
+    {
+        std::string json = session->game.getLastStats().toJson();
+        if (buffer && size > 0)
+        {
+            size_t copied = std::min(json.size(), size - 1);
+            std::memcpy(buffer, json.data(), copied);
+            buffer[copied] = '\0';
+        }
+        return json.size();
+    }
+    catch (...)
+    {
+        return 0;
+    }
+}
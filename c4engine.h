@@ -0,0 +1,124 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+
+C interface of the engine, built as a shared library (libc4engine.so,
+c4engine.dll) so that other languages can call it in-process instead of
+starting engine.exe per position. c4engine.py is the Python binding the
+Flask bridge uses.
+
+The interface mirrors the C++ split (engine.h, gamesession.h): one
+c4_engine holds the transposition table, book and score database, and
+any number of c4_session handles play games against it. Only plain C
+types cross the boundary, structs only ever grow at the end, and
+c4_api_version() tells a caller which version it got.
+
+Threads: the c4_engine_* setters and loaders must not run while a
+session searches. Each session is used by one thread at a time; different
+sessions may search at the same time. Destroy every session before its
+engine.
+
+Every function that can fail returns a c4_status; exceptions never cross
+the boundary.
+
+*/
+
+#if defined(_WIN32)
+#if defined(C4ENGINE_BUILD)
+#define C4_API __declspec(dllexport)
+#else
+#define C4_API __declspec(dllimport)
+#endif
+#else
+#define C4_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define C4_API_VERSION 2
+
+    typedef struct c4_engine c4_engine;
+    typedef struct c4_session c4_session;
+
+    typedef enum c4_status
+    {
+        C4_OK = 0,
+        C4_ILLEGAL_HISTORY = 1, /* a move is off the board, into a full column, or after a win */
+        C4_BOARD_FULL = 2,
+        C4_NOT_FOUND = 3,        /* a book or database file is missing or unreadable */
+        C4_INVALID_ARGUMENT = 4, /* a null handle or pointer */
+        C4_OUT_OF_MEMORY = 5,
+        C4_INTERNAL_ERROR = 6,
+        C4_GAME_OVER = 7 /* the last move of the history won the game */
+    } c4_status;
+
+    /* how a move's score relates to its true value */
+    typedef enum c4_bound
+    {
+        C4_BOUND_EXACT = 0,
+        C4_BOUND_LOWER = 1, /* at least this */
+        C4_BOUND_UPPER = 2  /* at most this */
+    } c4_bound;
+
+    /* the move c4_session_solve picks, like a --serve response */
+    typedef struct c4_result
+    {
+        int move;
+        int score;
+        int book;   /* straight from the opening book */
+        int proven; /* exact score from a solve that ran to the end */
+        uint64_t nodes;
+        int64_t time_ms;
+    } c4_result;
+
+    /* one legal move scored by c4_session_analyse */
+    typedef struct c4_move_score
+    {
+        int move;
+        int score;
+        int bound;   /* a c4_bound */
+        char pv[64]; /* the expected line as column digits, starting with move; cut short if longer */
+    } c4_move_score;
+
+    /* the whole of one c4_session_analyse call */
+    typedef struct c4_analysis
+    {
+        int count;  /* moves written, best first (every legal move if there was room) */
+        int proven; /* every score as exact as asked for */
+        uint64_t nodes;
+        int64_t time_ms;
+    } c4_analysis;
+
+    C4_API int c4_api_version(void);
+    C4_API const char *c4_status_message(c4_status status);
+
+    /* engine: created with a 512 MB table (mapped lazily), one thread, no limits and nothing loaded */
+    C4_API c4_status c4_engine_create(c4_engine **engine);
+    C4_API void c4_engine_destroy(c4_engine *engine);
+    C4_API c4_status c4_engine_load_book(c4_engine *engine, const char *path);
+    C4_API c4_status c4_engine_load_score_database(c4_engine *engine, const char *path);
+    C4_API c4_status c4_engine_set_tt_size(c4_engine *engine, size_t megabytes);
+    C4_API c4_status c4_engine_set_threads(c4_engine *engine, int threads);
+    C4_API c4_status c4_engine_set_limits(c4_engine *engine, int64_t move_time_ms, uint64_t max_nodes); /* 0 = none */
+    C4_API c4_status c4_engine_set_pondering(c4_engine *engine, int enabled);
+
+    /* session: one game; with pondering on, solve plays its move and searches the replies until the next call */
+    C4_API c4_status c4_session_create(c4_engine *engine, c4_session **session);
+    C4_API void c4_session_destroy(c4_session *session);
+    C4_API c4_status c4_session_solve(c4_session *session, const char *history, c4_result *result);
+    C4_API c4_status c4_session_analyse(c4_session *session, const char *history, int exact_scores,
+                                        c4_move_score *moves, int capacity, c4_analysis *analysis);
+
+    /* telemetry of the session's last search as JSON (SearchStats::toJson); like snprintf,
+    returns the full length and writes at most size bytes including the terminating NUL */
+    C4_API size_t c4_session_stats_json(const c4_session *session, char *buffer, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,203 @@
+"""ctypes binding of the engine's C interface (c4engine.h).
+
+Loads libc4engine.so (c4engine.dll on Windows, libc4engine.dylib on
+macOS) from this directory and wraps its handles in two classes: an
+Engine owns the transposition table, book and score database, and each
+Session plays one game against it. Results come back as dicts shaped like
+the --serve responses.
+
+    engine = Engine(pondering=True)
+    engine.load_book('opening_book.bin')
+    session = engine.session()
+    session.solve('3342')   # {'move': 2, 'score': 14, 'book': False, ...}
+"""
+
+import ctypes
+import json
+import os
+import sys
+
+API_VERSION = 2
+
+# c4_status
+OK = 0
+ILLEGAL_HISTORY = 1
+BOARD_FULL = 2
+NOT_FOUND = 3
+INVALID_ARGUMENT = 4
+OUT_OF_MEMORY = 5
+INTERNAL_ERROR = 6
+GAME_OVER = 7
+
+BOUNDS = ('exact', 'lower', 'upper')  # c4_bound
+
+
+class C4Error(Exception):
+    """A call that returned a status other than OK."""
+
+    def __init__(self, status):
+        super().__init__(_lib.c4_status_message(status).decode())
+        self.status = status
+
+
+class _Result(ctypes.Structure):
+    _fields_ = [('move', ctypes.c_int),
+                ('score', ctypes.c_int),
+                ('book', ctypes.c_int),
+                ('proven', ctypes.c_int),
+                ('nodes', ctypes.c_uint64),
+                ('time_ms', ctypes.c_int64)]
+
+
+class _MoveScore(ctypes.Structure):
+    _fields_ = [('move', ctypes.c_int),
+                ('score', ctypes.c_int),
+                ('bound', ctypes.c_int),
+                ('pv', ctypes.c_char * 64)]
+
+
+class _Analysis(ctypes.Structure):
+    _fields_ = [('count', ctypes.c_int),
+                ('proven', ctypes.c_int),
+                ('nodes', ctypes.c_uint64),
+                ('time_ms', ctypes.c_int64)]
+
+
+def _library_name():
+    if sys.platform.startswith('win'):
+        return 'c4engine.dll'
+    if sys.platform == 'darwin':
+        return 'libc4engine.dylib'
+    return 'libc4engine.so'
+
+
+def _load(path=None):
+    lib = ctypes.CDLL(path or os.path.join(os.path.dirname(os.path.abspath(__file__)), _library_name()))
+    handle = ctypes.c_void_p
+    signatures = {
+        'c4_api_version': (ctypes.c_int, []),
+        'c4_status_message': (ctypes.c_char_p, [ctypes.c_int]),
+        'c4_engine_create': (ctypes.c_int, [ctypes.POINTER(handle)]),
+        'c4_engine_destroy': (None, [handle]),
+        'c4_engine_load_book': (ctypes.c_int, [handle, ctypes.c_char_p]),
+        'c4_engine_load_score_database': (ctypes.c_int, [handle, ctypes.c_char_p]),
+        'c4_engine_set_tt_size': (ctypes.c_int, [handle, ctypes.c_size_t]),
+        'c4_engine_set_threads': (ctypes.c_int, [handle, ctypes.c_int]),
+        'c4_engine_set_limits': (ctypes.c_int, [handle, ctypes.c_int64, ctypes.c_uint64]),
+        'c4_engine_set_pondering': (ctypes.c_int, [handle, ctypes.c_int]),
+        'c4_session_create': (ctypes.c_int, [handle, ctypes.POINTER(handle)]),
+        'c4_session_destroy': (None, [handle]),
+        'c4_session_solve': (ctypes.c_int, [handle, ctypes.c_char_p, ctypes.POINTER(_Result)]),
+        'c4_session_analyse': (ctypes.c_int, [handle, ctypes.c_char_p, ctypes.c_int,
+                                              ctypes.POINTER(_MoveScore), ctypes.c_int, ctypes.POINTER(_Analysis)]),
+        'c4_session_stats_json': (ctypes.c_size_t, [handle, ctypes.c_char_p, ctypes.c_size_t]),
+    }
+    for name, (restype, argtypes) in signatures.items():
+        function = getattr(lib, name)
+        function.restype = restype
+        function.argtypes = argtypes
+
+    if lib.c4_api_version() != API_VERSION:
+        raise ImportError('%s has API version %d, this binding needs %d' % (_library_name(), lib.c4_api_version(), API_VERSION))
+    return lib
+
+
+_lib = _load(os.environ.get('C4ENGINE_LIBRARY'))
+
+
+def _check(status):
+    if status != OK:
+        raise C4Error(status)
+
+
+class Engine:
+    """Table, book, score database and settings shared by every session."""
+
+    def __init__(self, tt_mb=None, threads=1, pondering=False):
+        self._handle = ctypes.c_void_p()
+        _check(_lib.c4_engine_create(ctypes.byref(self._handle)))
+        if tt_mb:
+            _check(_lib.c4_engine_set_tt_size(self._handle, tt_mb))
+        self.set_threads(threads)
+        self.set_pondering(pondering)
+
+    def load_book(self, path='opening_book.bin'):
+        """Maps an opening book, False if there is none."""
+        status = _lib.c4_engine_load_book(self._handle, path.encode())
+        if status == NOT_FOUND:
+            return False
+        _check(status)
+        return True
+
+    def load_score_database(self, path='score_db.bin'):
+        """Maps an exact score database, False if there is none."""
+        status = _lib.c4_engine_load_score_database(self._handle, path.encode())
+        if status == NOT_FOUND:
+            return False
+        _check(status)
+        return True
+
+    def set_tt_size(self, megabytes):
+        _check(_lib.c4_engine_set_tt_size(self._handle, megabytes))
+
+    def set_threads(self, threads):
+        _check(_lib.c4_engine_set_threads(self._handle, threads))
+
+    def set_limits(self, move_time_ms=0, max_nodes=0):
+        _check(_lib.c4_engine_set_limits(self._handle, move_time_ms, max_nodes))
+
+    def set_pondering(self, enabled):
+        _check(_lib.c4_engine_set_pondering(self._handle, 1 if enabled else 0))
+
+    def session(self):
+        return Session(self)
+
+    def close(self):
+        """Frees the engine; close its sessions first."""
+        if self._handle:
+            _lib.c4_engine_destroy(self._handle)
+            self._handle = ctypes.c_void_p()
+
+    def __del__(self):
+        self.close()
+
+
+class Session:
+    """One game. Use it from one thread at a time."""
+
+    def __init__(self, engine):
+        self._engine = engine  # keeps the engine alive as long as the session
+        self._handle = ctypes.c_void_p()
+        _check(_lib.c4_session_create(engine._handle, ctypes.byref(self._handle)))
+
+    def solve(self, history):
+        """The engine's move after a move history such as '3342'."""
+        result = _Result()
+        _check(_lib.c4_session_solve(self._handle, history.encode(), ctypes.byref(result)))
+        return {'move': result.move, 'score': result.score, 'book': bool(result.book),
+                'proven': bool(result.proven), 'nodes': result.nodes, 'time_ms': result.time_ms}
+
+    def analyse(self, history, exact=True):
+        """Every legal move with its score, bound and expected line, best first."""
+        moves = (_MoveScore * 16)()
+        analysis = _Analysis()
+        _check(_lib.c4_session_analyse(self._handle, history.encode(), 1 if exact else 0,
+                                       moves, len(moves), ctypes.byref(analysis)))
+        return {'moves': [{'move': m.move, 'score': m.score, 'bound': BOUNDS[m.bound], 'pv': m.pv.decode()}
+                          for m in moves[:analysis.count]],
+                'proven': bool(analysis.proven), 'nodes': analysis.nodes, 'time_ms': analysis.time_ms}
+
+    def stats(self):
+        """Telemetry of the last search (SearchStats::toJson)."""
+        size = _lib.c4_session_stats_json(self._handle, None, 0)
+        buffer = ctypes.create_string_buffer(size + 1)
+        _lib.c4_session_stats_json(self._handle, buffer, len(buffer))
+        return json.loads(buffer.value.decode())
+
+    def close(self):
+        if self._handle:
+            _lib.c4_session_destroy(self._handle)
+            self._handle = ctypes.c_void_p()
+
+    def __del__(self):
+        self.close()
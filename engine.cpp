@@ -0,0 +1,707 @@
+#include "engine.h"
+#include <iostream>
+#include <utility>
+#include <chrono>
+#include <vector>
+#include <iomanip>
+#include <fstream>
+#include <algorithm> // max
+#include <atomic>
+#include <thread>
+#include <cstdio>    // remove
+
+// constructor for the Engine class, initializes the settings and the transposition table
+Engine::Engine() : transpositionTable(transTableMB), numThreads(1), ordering(MoveOrdering::Threats), incrementalEval(true),
+                   exactSolver(true), verbose(true), printStats(false), ponder(false), moveTimeMs(0), maxNodes(0)
+{
+}
+
+// sets how many threads every search runs on (1 = main thread only)
+void Engine::setThreads(int threads)
+{
+    numThreads = std::max(1, threads);
+}
+
+// selects how every search thread orders its moves
+void Engine::setMoveOrdering(MoveOrdering moveOrdering)
+{
+    ordering = moveOrdering;
+}
+
+// selects how every search thread scores heuristic leaves (both give the same scores)
+void Engine::setIncrementalEval(bool enabled)
+{
+    incrementalEval = enabled;
+}
+
+// chooses between exact score bisection and iterative deepening for strong positions
+void Engine::setExactSolver(bool enabled)
+{
+    exactSolver = enabled;
+}
+
+// turns the JSON search stats on stderr on or off
+void Engine::setStatsOutput(bool enabled)
+{
+    printStats = enabled;
+}
+
+/* bounds every following search by time and/or nodes (0 = unbounded).
+A search that hits a limit answers with the best move of its last
+completed depth, which is not proven. */
+void Engine::setLimits(long long moveTime, uint64_t nodes)
+{
+    moveTimeMs = std::max(0LL, moveTime);
+    maxNodes = nodes;
+}
+
+/* turns pondering on or off: a session's startPondering then searches the
+opponent's replies in the background until their move comes in */
+void Engine::setPondering(bool enabled)
+{
+    ponder = enabled;
+}
+
+// empties the transposition table (O(1))
+void Engine::clearTranspositionTable()
+{
+    transpositionTable.clear();
+}
+
+// replaces the transposition table with an empty one of the given size
+void Engine::setTranspositionTableSize(size_t megabytes)
+{
+    transpositionTable.resize(megabytes);
+}
+
+/* plays a move history on an empty board, false (and an empty board) if a
+move is illegal or follows a win. A history ending with the winning move is
+legal; callers check checkWin() to report the game as over. */
+bool Engine::parseHistory(const std::string &history, Board &position)
+{
+    position = Board();
+    for (char c : history)
+    {
+        int col = c - '0'; // Convert char to int
+        if (col < 0 || col >= Board::WIDTH || position.checkWin() || !position.makeMove(col))
+        {
+            position = Board();
+            return false;
+        }
+    }
+    return true;
+}
+
+// turns progress output on or off
+void Engine::setVerbose(bool enabled)
+{
+    verbose = enabled;
+}
+
+/* Gathers every canonical position of the opening tree up to maxMoves
+that is not in the book yet. A position whose canonical key was already
+seen is skipped with its whole subtree: the subtree is the same (or the
+mirror image) as the one below the first occurrence. */
+void Engine::collectBookPositions(const Board &position, int maxMoves, std::unordered_set<uint64_t> &seen, std::vector<Board> &positions) const
+{
+    if (position.numMoves() > maxMoves || position.checkWin())
+        return;
+
+    bool isMirror = false;
+    uint64_t key = (uint64_t)position.canonicalKey(isMirror); // fits, buildOpeningBook checks OpeningBook::SUPPORTED
+    if (!seen.insert(key).second)
+        return;
+
+    if (bookEntries.find(key) == bookEntries.end())
+    {
+        positions.push_back(position);
+    }
+
+    for (int col = 0; col < Board::WIDTH; col++)
+    {
+        if (position.checkMove(col))
+        {
+            Board next = position;
+            next.makeMove(col);
+            collectBookPositions(next, maxMoves, seen, positions);
+        }
+    }
+}
+
+/* One book generation thread. Solves positions from the back of its own
+queue, then steals from the front of the others' until every queue is
+empty. Results are kept locally and handed to the log writer in blocks,
+so the shared lock is taken once per block instead of once per node. */
+void Engine::solveBookPositions(int id, std::vector<std::unique_ptr<BookQueue>> &queues, int searchDepth, bool usingOldScoreFunction, BookBuild &build)
+{
+    const size_t FLUSH_EVERY = 16;
+
+    std::unique_ptr<Searcher> worker = newWorker(0);
+    std::vector<BookEntry> solved;
+    uint64_t nodes = 0;
+    uint64_t reportedTTSize = 0, reportedCollisions = 0;
+
+    while (true)
+    {
+        // Own queue first, then steal the oldest position of another thread
+        Board position;
+        bool found = false;
+        for (size_t i = 0; i < queues.size() && !found; i++)
+        {
+            BookQueue &queue = *queues[(id + i) % queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.positions.empty())
+            {
+                if (i == 0)
+                {
+                    position = queue.positions.back();
+                    queue.positions.pop_back();
+                }
+                else
+                {
+                    position = queue.positions.front();
+                    queue.positions.pop_front();
+                }
+                found = true;
+            }
+        }
+
+        if (found)
+        {
+            bool isMirror = false;
+            uint64_t key = (uint64_t)position.canonicalKey(isMirror);
+            int currentScore = 0;
+            int canonicalBestMove = Board::WIDTH / 2; // Default fallback
+
+            worker->newSearch();
+            for (int d = 1; d <= searchDepth; d++)
+            {
+                auto result = worker->MTD(position, currentScore, d, usingOldScoreFunction);
+                currentScore = result.first;
+                if (result.second != -1)
+                {
+                    // If the board is mirrored, we MUST flip the move before saving to the canonical dictionary!
+                    canonicalBestMove = isMirror ? (Board::WIDTH - 1 - result.second) : result.second;
+                }
+            }
+            /* MTD converges on the exact score of the last depth. Scores of the
+            old evaluation are on another scale, so those entries keep only their move. */
+            BookEntry entry = OpeningBook::moveOnly(key, canonicalBestMove);
+            if (!usingOldScoreFunction && searchDepth > 0)
+            {
+                entry.score = (int16_t)std::max(-32767, std::min(32767, currentScore));
+                entry.bound = OpeningBook::BOUND_EXACT;
+                entry.depth = (uint8_t)std::min(searchDepth, 255);
+            }
+            solved.push_back(entry);
+            nodes += worker->nodesEvaluated;
+        }
+
+        if (!found && solved.empty())
+            return;
+        if (found && solved.size() < FLUSH_EVERY)
+            continue;
+
+        {
+            std::lock_guard<std::mutex> lock(build.mutex);
+            build.pending.insert(build.pending.end(), solved.begin(), solved.end());
+            build.solved += solved.size();
+            build.nodes += nodes;
+            build.ttSize += worker->ttSize - reportedTTSize;
+            build.ttCollisions += worker->ttCollisions - reportedCollisions;
+            reportedTTSize = worker->ttSize;
+            reportedCollisions = worker->ttCollisions;
+
+            if (verbose)
+            {
+                std::cout << "\r[Positions: " << build.solved << "/" << build.total
+                          << "] [Nodes: " << (build.nodes / 1000000) << "M] "
+                          << "[TT Fill: " << std::fixed << std::setprecision(2) << 100.0 * build.ttSize / transpositionTable.capacity() << "%] "
+                          << "[TT Collisions: " << (build.ttCollisions / 1000000) << "M]      " << std::flush;
+            }
+        }
+        build.solvedReady.notify_one();
+        solved.clear();
+        nodes = 0;
+
+        if (!found)
+            return;
+    }
+}
+
+/* The book build's only writer: appends whatever the generator threads
+have solved to the log and adds it to bookEntries, until the threads are
+done and nothing is left. Disk writes happen outside the lock, so no
+generator thread ever waits for the disk. */
+void Engine::writeBookLog(BookLog &log, BookBuild &build)
+{
+    std::vector<BookEntry> batch;
+    bool logFailed = false;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(build.mutex);
+            build.solvedReady.wait(lock, [&build]
+                                   { return !build.pending.empty() || build.workersDone; });
+            if (build.pending.empty())
+            {
+                return;
+            }
+            batch.swap(build.pending);
+        }
+
+        if (!log.append(batch) && !logFailed)
+        {
+            std::cerr << "\nCould not write to the book log, this build cannot be resumed if it is interrupted.\n";
+            logFailed = true;
+        }
+        for (const auto &entry : batch)
+        {
+            bookEntries[entry.key] = entry;
+        }
+        batch.clear();
+    }
+}
+
+/* Builds the opening book: first enumerates the unique canonical positions
+up to maxMoves, then solves them with a depth-limited search on the given
+number of threads. Each thread has its own searcher (sharing the
+transposition table) and its own work queue, and idle threads steal work,
+so the build is not held up by whichever part of the tree is slowest.
+
+Solved positions go to opening_book.log as they come in; the book itself
+is written once at the end and the log deleted. An interrupted build
+resumes from the log without solving anything twice. */
+void Engine::buildOpeningBook(int maxMoves, int searchDepth, bool usingOldScoreFunction, int threads)
+{
+    if (!OpeningBook::SUPPORTED)
+    {
+        std::cout << "Opening books need keys of at most 64 bits; this board size has " << Board::KEY_BITS << ".\n";
+        return;
+    }
+
+    // Resume from the existing book, then release the mapping so the file can be replaced
+    loadOpeningBook();
+    openingBook.copyTo(bookEntries);
+    openingBook.close();
+
+    // ... and from the log of a build that did not finish
+    const std::string logPath = "opening_book.log";
+    size_t fromBook = bookEntries.size();
+    BookLog log;
+    if (!log.open(logPath, bookEntries))
+    {
+        std::cout << "Could not open " << logPath << ", not building.\n";
+        return;
+    }
+    if (verbose && bookEntries.size() > fromBook)
+        std::cout << "Resuming an interrupted build: " << bookEntries.size() - fromBook << " positions from " << logPath << "\n";
+
+    Board emptyBoard;
+    bool isMirror;
+    uint64_t emptyKey = (uint64_t)emptyBoard.canonicalKey(isMirror);
+    bookEntries[emptyKey] = OpeningBook::moveOnly(emptyKey, Board::WIDTH / 2); // the center is the mathematically proven best first move on the standard board
+
+    std::unordered_set<uint64_t> seen;
+    std::vector<Board> positions;
+    collectBookPositions(emptyBoard, maxMoves, seen, positions);
+    if (verbose)
+        std::cout << seen.size() << " canonical positions up to ply " << maxMoves << ", " << positions.size() << " to solve\n";
+
+    // Deal the positions out round-robin, so every queue holds a mix of shallow and deep ones
+    threads = std::max(1, threads);
+    std::vector<std::unique_ptr<BookQueue>> queues;
+    for (int i = 0; i < threads; i++)
+    {
+        queues.emplace_back(new BookQueue());
+    }
+    for (size_t i = 0; i < positions.size(); i++)
+    {
+        queues[i % threads]->positions.push_back(positions[i]);
+    }
+
+    BookBuild build;
+    build.total = positions.size();
+    transpositionTable.newSearch();
+
+    std::thread writer([this, &log, &build]()
+                       { writeBookLog(log, build); });
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; i++)
+    {
+        workers.emplace_back([this, i, &queues, searchDepth, usingOldScoreFunction, &build]()
+                             { solveBookPositions(i, queues, searchDepth, usingOldScoreFunction, build); });
+    }
+
+    for (auto &th : workers)
+        th.join();
+    {
+        std::lock_guard<std::mutex> lock(build.mutex);
+        build.workersDone = true;
+    }
+    build.solvedReady.notify_one();
+    writer.join();
+    if (verbose)
+        std::cout << "\n";
+
+    // Compact: the log becomes the book, and is only deleted once the book is safely written
+    log.close();
+    if (saveOpeningBook())
+    {
+        std::remove(logPath.c_str());
+    }
+    else
+    {
+        std::cout << "The solved positions are kept in " << logPath << "\n";
+    }
+}
+
+// maps opening_book.bin from the working directory into memory
+void Engine::loadOpeningBook()
+{
+    loadOpeningBook("opening_book.bin");
+}
+
+// maps an opening book file into memory (while no session is searching: they may be reading the old one)
+bool Engine::loadOpeningBook(const std::string &path)
+{
+    if (!openingBook.open(path))
+    {
+        if (verbose)
+        {
+            if (OpeningBook::isLegacyFile(path))
+                std::cout << "Opening book is in the old format. Run with --convert-book to upgrade it.\n";
+            std::cout << "No opening book found. AI will calculate from scratch.\n";
+        }
+        return false;
+    }
+
+    if (verbose)
+        std::cout << "Loaded " << openingBook.size() << " perfect opening moves into AI memory.\n";
+    return true;
+}
+
+// maps score_db.bin from the working directory into memory
+void Engine::loadScoreDatabase()
+{
+    loadScoreDatabase("score_db.bin");
+}
+
+// maps an exact score database into memory, like loadOpeningBook
+bool Engine::loadScoreDatabase(const std::string &path)
+{
+    if (!scoreDatabase.open(path))
+    {
+        return false; // optional, the search simply solves those plies itself
+    }
+
+    if (verbose)
+        std::cout << "Loaded exact scores of " << scoreDatabase.size() << " positions at ply " << scoreDatabase.ply() << ".\n";
+    return true;
+}
+
+/* Solves every canonical position at the given ply (or only those of the
+given move histories that have exactly ply moves) on a pool of threads
+and writes them to score_db.bin. Meant to run offline: on the standard
+board ply 12 has about 5.8 million canonical positions still in play
+(11.7 million before mirror reduction), each solved exactly. */
+void Engine::buildScoreDatabase(int ply, int threads, const std::vector<std::string> *histories)
+{
+    if (!ScoreDatabase::SUPPORTED)
+    {
+        std::cout << "The score database needs keys of at most 64 bits; this board size has " << Board::KEY_BITS << ".\n";
+        return;
+    }
+
+    // The database being replaced must not answer its own positions
+    scoreDatabase.close();
+
+    /* Breadth-first over canonical positions: each ply is deduplicated
+    before the next is expanded, and positions that are already won or
+    full are left out. */
+    std::vector<Board> positions;
+    if (!histories)
+    {
+        positions.push_back(Board());
+        for (int p = 0; p < ply; p++)
+        {
+            std::unordered_set<uint64_t> seen;
+            std::vector<Board> next;
+            for (const Board &position : positions)
+            {
+                for (int col = 0; col < Board::WIDTH; col++)
+                {
+                    Board child = position;
+                    bool isMirror = false;
+                    if (child.checkMove(col) && child.makeMove(col) && !child.checkWin() && child.numMoves() < Board::CELLS &&
+                        seen.insert((uint64_t)child.canonicalKey(isMirror)).second)
+                    {
+                        next.push_back(child);
+                    }
+                }
+            }
+            positions.swap(next);
+        }
+    }
+    else
+    {
+        std::unordered_set<uint64_t> seen;
+        for (const std::string &history : *histories)
+        {
+            Board position;
+            bool isMirror = false;
+            if (parseHistory(history, position) && position.numMoves() == ply && ply < Board::CELLS && !position.checkWin() &&
+                seen.insert((uint64_t)position.canonicalKey(isMirror)).second)
+            {
+                positions.push_back(position);
+            }
+        }
+    }
+    if (verbose)
+        std::cout << positions.size() << " canonical positions at ply " << ply << " to solve\n";
+
+    // Every thread takes the next unsolved position; they all cost about the same
+    std::vector<std::pair<uint64_t, int>> scores(positions.size());
+    std::atomic<size_t> nextPosition(0), solved(0);
+    std::mutex outputMutex;
+    std::vector<std::thread> workers;
+    transpositionTable.newSearch();
+    for (int i = 0; i < std::max(1, threads); i++)
+    {
+        workers.emplace_back([this, &positions, &scores, &nextPosition, &solved, &outputMutex]()
+                             {
+            std::unique_ptr<Searcher> worker = newWorker(0);
+            worker->strongSolver = true;
+            for (size_t index = nextPosition++; index < positions.size(); index = nextPosition++)
+            {
+                bool isMirror = false;
+                worker->newSearch();
+                scores[index] = {(uint64_t)positions[index].canonicalKey(isMirror), worker->solve(positions[index]).first};
+
+                size_t done = ++solved;
+                if (verbose && (done % 64 == 0 || done == positions.size()))
+                {
+                    std::lock_guard<std::mutex> lock(outputMutex);
+                    std::cout << "\r[Solved: " << done << "/" << positions.size() << "]      " << std::flush;
+                }
+            } });
+    }
+    for (auto &th : workers)
+        th.join();
+    if (verbose)
+        std::cout << "\n";
+
+    if (!ScoreDatabase::write("score_db.bin", ply, scores))
+    {
+        std::cout << "Failed to write score_db.bin\n";
+        return;
+    }
+    loadScoreDatabase();
+}
+
+/* Picks the move one ply before the score database: every child is in it
+(or wins on the spot), so the best move and its exact score need no search.
+False if the database does not cover this position. */
+bool Engine::databaseMove(const Board &position, int &move, int &score) const
+{
+    if (position.numMoves() != scoreDatabase.ply() - 1)
+    {
+        return false;
+    }
+
+    Board::Bitboard winningMoves = position.winningPositions() & position.possible();
+    move = -1;
+    score = -Board::CELLS;
+    for (int offset = 0; offset < Board::WIDTH; offset++)
+    {
+        // Center first, so ties go to the middle
+        int col = Board::WIDTH / 2 + (offset % 2 ? (offset + 1) / 2 : -(offset / 2));
+        if (col < 0 || col >= Board::WIDTH || !position.checkMove(col))
+        {
+            continue;
+        }
+
+        int childScore;
+        if (winningMoves & Board::columnMask(col))
+        {
+            childScore = (Board::CELLS + 1 - position.numMoves()) / 2;
+        }
+        else
+        {
+            Board child = position;
+            child.makeMove(col);
+            bool isMirror = false;
+            int exact = 0;
+            if (child.numMoves() < Board::CELLS && !scoreDatabase.probe((uint64_t)child.canonicalKey(isMirror), exact))
+            {
+                return false;
+            }
+            childScore = -exact;
+        }
+
+        if (childScore > score)
+        {
+            move = col;
+            score = childScore;
+        }
+    }
+    return move != -1;
+}
+
+// Safely serializes the generated book to the hard drive
+bool Engine::saveOpeningBook()
+{
+    if (!OpeningBook::write("opening_book.bin", bookEntries))
+    {
+        std::cout << "\nFailed to write opening_book.bin\n";
+        return false;
+    }
+    return true;
+}
+
+// gives a searcher the engine's move ordering, evaluation, book and score database
+void Engine::configure(Searcher &searcher) const
+{
+    searcher.ordering = ordering;
+    searcher.incrementalEval = incrementalEval;
+    searcher.setBook(&openingBook);
+    searcher.setScoreDatabase(&scoreDatabase);
+}
+
+// bounds a search started at start by the per-move time and node limits
+void Engine::applyLimits(Searcher &searcher, std::chrono::steady_clock::time_point start) const
+{
+    searcher.setLimits(maxNodes, moveTimeMs > 0 ? start + std::chrono::milliseconds(moveTimeMs) : std::chrono::steady_clock::time_point::max());
+}
+
+// a searcher on the shared transposition table, set up like the Lazy SMP helpers (id 0 keeps the main move order)
+std::unique_ptr<Searcher> Engine::newWorker(int id)
+{
+    std::unique_ptr<Searcher> worker(new Searcher(transpositionTable, id));
+    configure(*worker);
+    return worker;
+}
+
+/* Searches one position from scratch on the calling thread, the way a
+session's getAIMove would in a fresh game: book, then the exact solver
+from STRONG_SOLVER_PLY on, else iterative deepening. Only reads the
+engine, so any number of workers can call it at once, each with its own
+searcher; they meet in the shared transposition table. */
+Analysis Engine::analysePosition(const Board &position, Searcher &worker) const
+{
+    auto start = std::chrono::steady_clock::now();
+    Analysis result = {-1, 0, false, false, 0, 0};
+
+    bool isMirror = false;
+    BookEntry bookEntry;
+    if (OpeningBook::SUPPORTED && openingBook.probe((uint64_t)position.canonicalKey(isMirror), bookEntry))
+    {
+        result.move = isMirror ? (Board::WIDTH - 1 - bookEntry.move) : bookEntry.move;
+        result.score = bookEntry.bound == OpeningBook::BOUND_NONE ? 0 : bookEntry.score;
+        result.book = true;
+        return result;
+    }
+
+    if (databaseMove(position, result.move, result.score))
+    {
+        result.proven = true;
+        result.timeMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        return result;
+    }
+
+    bool strong = position.numMoves() >= STRONG_SOLVER_PLY;
+    worker.strongSolver = strong;
+    worker.newSearch();
+    applyLimits(worker, start);
+
+    if (strong && exactSolver)
+    {
+        auto solved = worker.solve(position);
+        result.move = solved.second;
+        result.score = solved.first;
+        result.proven = !worker.wasStopped();
+    }
+    else
+    {
+        int maxDepth = strong ? Board::CELLS - position.numMoves() : 20;
+        int depth = 1;
+        for (; depth <= maxDepth; depth++)
+        {
+            auto searched = worker.MTD(position, result.score, depth, false);
+            if (worker.wasStopped())
+            {
+                break;
+            }
+            result.score = searched.first;
+            if (searched.second != -1)
+            {
+                result.move = searched.second;
+            }
+        }
+        if (result.move == -1)
+        {
+            result.move = worker.fallbackMove(position);
+        }
+        result.proven = strong && depth > maxDepth;
+    }
+
+    result.nodes = worker.nodesEvaluated;
+    result.timeMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+/* Scores every legal move of a position in one search, the way
+analysePosition would pick one: exactly from STRONG_SOLVER_PLY on, or
+when every child is in the score database, else at the depth iterative
+deepening reaches (where exactScores does not apply). The book is
+skipped at the root, since an entry gives one heuristic score for the
+position, not a score for each move. */
+MoveAnalysis Engine::analyseMoves(const Board &position, Searcher &worker, bool exactScores) const
+{
+    auto start = std::chrono::steady_clock::now();
+    MoveAnalysis result = {{}, false, 0, 0};
+
+    int databaseScore;
+    int databaseBest;
+    bool strong = position.numMoves() >= STRONG_SOLVER_PLY || databaseMove(position, databaseBest, databaseScore);
+    worker.strongSolver = strong;
+    worker.newSearch();
+    applyLimits(worker, start);
+
+    if (strong && exactSolver)
+    {
+        result.moves = worker.solveMoves(position, exactScores);
+        result.proven = !worker.wasStopped();
+    }
+    else
+    {
+        int maxDepth = strong ? Board::CELLS - position.numMoves() : 20;
+        int score = 0;
+        int move = -1;
+        int depth = 1;
+        for (; depth <= maxDepth; depth++)
+        {
+            auto searched = worker.MTD(position, score, depth, false);
+            if (worker.wasStopped())
+            {
+                break;
+            }
+            score = searched.first;
+            if (searched.second != -1)
+            {
+                move = searched.second;
+            }
+        }
+
+        // Stopped before the first depth was done: there are no scores to give
+        if (depth > 1)
+        {
+            result.moves = worker.searchMoves(position, depth - 1, score, move, false);
+        }
+        result.proven = strong && depth > maxDepth && !worker.wasStopped();
+    }
+
+    result.nodes = worker.nodesEvaluated;
+    result.timeMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
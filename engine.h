@@ -0,0 +1,163 @@
+#pragma once
+
+#include "board.h"
+#include "book.h"
+#include "scoredb.h"
+#include "searcher.h"
+#include "transpositiontable.h"
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <unordered_map> // book generation
+#include <unordered_set>
+#include <deque>         // book generation work queues
+#include <mutex>         // multithreading book generation
+#include <condition_variable>
+#include <string>
+#include <memory>        // worker searchers
+
+/*
+
+Engine state shared by every game a process plays.
+
+The engine owns what is large and the same for every game: the
+transposition table, the opening book and the score database (both
+mapped read-only), and the search settings. Everything a single game
+changes lives in a GameSession (gamesession.h): its board, its searchers
+with their history tables and counters, and the results of its last
+search. Sessions only read the engine while they search and the table is
+lock-free, so one process can serve any number of games at once, each on
+its own thread, with one copy of the table and the book between them.
+
+Settings, loading files and clearing or resizing the table are not
+synchronised with searches: they belong before sessions start, or to
+moments when none of them is searching.
+
+*/
+
+// answer for one position searched on its own by analysePosition
+struct Analysis
+{
+    int move;
+    int score;
+    bool book;
+    bool proven;
+    uint64_t nodes;
+    long long timeMs;
+};
+
+// every legal move of one position scored by analyseMoves, best first
+struct MoveAnalysis
+{
+    std::vector<RootMove> moves;
+    bool proven; // exact solver scores, every one as exact as asked for
+    uint64_t nodes;
+    long long timeMs;
+};
+
+class Engine
+{
+private:
+    // Transposition table shared by every search (512 MB unless --tt-mb is given)
+    const size_t transTableMB = 512;
+    TranspositionTable transpositionTable;
+
+    // Opening book for the first few moves to speed up the game and make it more challenging
+    OpeningBook openingBook;
+
+    // Exact scores of every position at one ply past the book (score_db.bin), if there is one
+    ScoreDatabase scoreDatabase;
+
+    // Threads per search: a session's main searcher plus its Lazy SMP helpers
+    int numThreads;
+
+    MoveOrdering ordering;
+    bool incrementalEval;
+
+    // Strong positions are solved exactly by score bisection unless the old iterative deepening is requested
+    bool exactSolver;
+
+    // Progress output toggle (disabled when stdout is a protocol channel)
+    bool verbose;
+
+    // Telemetry output toggle: JSON stats on stderr after every search
+    bool printStats;
+
+    // Sessions search the opponent's replies while they think
+    bool ponder;
+
+    // Search limits per move (0 = none): wall-clock budget and main thread nodes
+    long long moveTimeMs;
+    uint64_t maxNodes;
+
+    // Book positions solved so far while generating a book (canonical key -> entry)
+    std::unordered_map<uint64_t, BookEntry> bookEntries;
+
+    // Book generation: every thread owns a queue of positions to solve and steals from the others once it is empty
+    struct BookQueue
+    {
+        std::mutex mutex;
+        std::deque<Board> positions;
+    };
+
+    // Solved book positions on their way to the log writer, and the build's progress
+    struct BookBuild
+    {
+        std::mutex mutex; // guards everything below
+        std::condition_variable solvedReady;
+        std::vector<BookEntry> pending;
+        bool workersDone = false;
+
+        size_t total = 0;
+        size_t solved = 0;
+        uint64_t nodes = 0;
+        uint64_t ttSize = 0;
+        uint64_t ttCollisions = 0;
+    };
+
+    void collectBookPositions(const Board &position, int maxMoves, std::unordered_set<uint64_t> &seen, std::vector<Board> &positions) const;
+    void solveBookPositions(int id, std::vector<std::unique_ptr<BookQueue>> &queues, int searchDepth, bool usingOldScoreFunction, BookBuild &build);
+    void writeBookLog(BookLog &log, BookBuild &build);
+
+public:
+    // ply from which searches solve exactly: 30 empty cells left, move 12 on the standard board
+    static constexpr int STRONG_SOLVER_PLY = Board::CELLS > 30 ? Board::CELLS - 30 : 0;
+
+    Engine();
+    void setVerbose(bool enabled);
+    void setThreads(int threads);
+    void setMoveOrdering(MoveOrdering ordering);
+    void setExactSolver(bool enabled);
+    void setIncrementalEval(bool enabled);
+    void setStatsOutput(bool enabled);
+    void setLimits(long long moveTimeMs, uint64_t maxNodes);
+    void setPondering(bool enabled);
+    void clearTranspositionTable();
+    void setTranspositionTableSize(size_t megabytes);
+
+    void buildOpeningBook(int maxMoves, int searchDepth, bool usingOldScoreFunction, int threads);
+    void loadOpeningBook(); // opening_book.bin in the working directory
+    bool loadOpeningBook(const std::string &path);
+    void loadScoreDatabase(); // score_db.bin in the working directory
+    bool loadScoreDatabase(const std::string &path);
+    void buildScoreDatabase(int ply, int threads, const std::vector<std::string> *histories); // nullptr: every position
+    bool saveOpeningBook();
+
+    // What every session searches with
+    int threads() const { return numThreads; }
+    bool isVerbose() const { return verbose; }
+    bool usesExactSolver() const { return exactSolver; }
+    bool printsStats() const { return printStats; }
+    bool pondering() const { return ponder; }
+    TranspositionTable &table() { return transpositionTable; }
+    const OpeningBook &book() const { return openingBook; }
+    void configure(Searcher &searcher) const; // move ordering, evaluation, book and database
+    void applyLimits(Searcher &searcher, std::chrono::steady_clock::time_point start) const;
+    bool databaseMove(const Board &position, int &move, int &score) const;
+
+    // Independent positions searched side by side (batch mode, hints), each worker on its own thread
+    static bool parseHistory(const std::string &history, Board &position);
+    std::unique_ptr<Searcher> newWorker(int id);
+    Analysis analysePosition(const Board &position, Searcher &worker) const;
+    MoveAnalysis analyseMoves(const Board &position, Searcher &worker, bool exactScores) const;
+};
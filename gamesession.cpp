@@ -0,0 +1,668 @@
+#include "gamesession.h"
+#include <iostream>
+#include <utility>
+#include <chrono>
+#include <vector>
+#include <iomanip>
+#include <algorithm> // max
+
+// constructor for the GameSession class, initializes scores, nodes evaluated and the main searcher on the engine's table
+GameSession::GameSession(Engine &engine) : engine(engine), scorePlayer1(0), scorePlayer2(0),
+                                           nodesEvaluated(0), lastScore(0), lastBookMove(false), lastSearchTime(0), lastProbes(0), lastProven(false),
+                                           searcher(engine.table(), 0), stopPonder(false)
+{
+    engine.configure(searcher);
+    std::fill(ponderKeys, ponderKeys + Board::WIDTH, 0);
+}
+
+// stops a ponder search that is still running
+GameSession::~GameSession()
+{
+    stopPondering();
+}
+
+/* matches the Lazy SMP helpers to the engine's thread count and gives
+every searcher the engine's current settings, before each search */
+void GameSession::prepareSearchers()
+{
+    int numHelpers = engine.threads() - 1;
+    while ((int)helpers.size() < numHelpers)
+    {
+        helpers.emplace_back(new Searcher(engine.table(), (int)helpers.size() + 1));
+    }
+    helpers.resize(numHelpers);
+
+    engine.configure(searcher);
+    for (auto &helper : helpers)
+    {
+        engine.configure(*helper);
+    }
+}
+
+/* Starts pondering the current board, where the opponent is to move, if
+pondering is on and the game goes on. Anything that needs the main
+searcher or the table again (getAIMove first of all) stops it. */
+void GameSession::startPondering()
+{
+    stopPondering();
+    std::fill(ponderKeys, ponderKeys + Board::WIDTH, 0);
+    if (!engine.pondering() || board.checkWin() || board.numMoves() >= Board::CELLS)
+    {
+        return;
+    }
+
+    prepareSearchers();
+    engine.table().newSearch();
+    searcher.newSearch();
+    searcher.setLimits(0, std::chrono::steady_clock::time_point::max());
+    stopPonder = false;
+    searcher.setStopFlag(&stopPonder);
+    ponderThread = std::thread(&GameSession::ponder, this, board);
+}
+
+// cancels pondering, because the opponent's move is in, and waits for the thread
+void GameSession::stopPondering()
+{
+    if (ponderThread.joinable())
+    {
+        stopPonder = true;
+        ponderThread.join();
+        searcher.setStopFlag(nullptr);
+    }
+}
+
+/* Body of the ponder thread. The reply the last search expects comes
+first, then the rest in move order; replies the book or the score
+database answer cost nothing later and are skipped. From the ply where
+getAIMove solves exactly, the replies are solved one after the other,
+which leaves their proofs in the table. Before it, the expected reply is
+searched to the full depth first, then the others are deepened one ply
+at a time in turn, so the time left is shared out however long the
+opponent takes. Each finished depth leaves its score as the first guess
+for the search that follows the reply. */
+void GameSession::ponder(const Board position)
+{
+    int expected = searcher.tableMove(position, true);
+    if (expected == -1)
+    {
+        expected = searcher.tableMove(position, false);
+    }
+
+    int replies[Board::WIDTH];
+    Board children[Board::WIDTH];
+    int numReplies = 0;
+    for (int i = -1; i < Board::WIDTH; i++)
+    {
+        int col = i == -1 ? expected : searcher.moveOrder[i];
+        if (col == -1 || (i >= 0 && col == expected) || !position.checkMove(col))
+        {
+            continue;
+        }
+
+        Board child = position;
+        child.makeMove(col);
+        bool isMirror = false;
+        BookEntry bookEntry;
+        int databaseBest;
+        int databaseScore;
+        if (child.checkWin() || child.numMoves() == Board::CELLS ||
+            (OpeningBook::SUPPORTED && engine.book().probe((uint64_t)child.canonicalKey(isMirror), bookEntry)) ||
+            engine.databaseMove(child, databaseBest, databaseScore))
+        {
+            continue;
+        }
+        replies[numReplies] = col;
+        children[numReplies++] = child;
+    }
+
+    bool strong = position.numMoves() + 1 >= Engine::STRONG_SOLVER_PLY;
+    searcher.strongSolver = strong;
+    if (strong && engine.usesExactSolver())
+    {
+        for (int i = 0; i < numReplies && !searcher.wasStopped(); i++)
+        {
+            searcher.solve(children[i]);
+        }
+        return;
+    }
+
+    // One more depth on a reply, false once the opponent has moved
+    int guesses[Board::WIDTH] = {0};
+    auto deepen = [&](int i, int depth)
+    {
+        int score = searcher.MTD(children[i], guesses[i], depth, false).first;
+        if (searcher.wasStopped())
+        {
+            return false;
+        }
+        guesses[i] = score;
+        bool isMirror = false;
+        ponderScores[replies[i]] = score;
+        ponderKeys[replies[i]] = children[i].hash(isMirror);
+        return true;
+    };
+
+    // The expected reply is searched as deep as getAIMove will search it, then the others share the time left
+    int maxDepth = strong ? Board::CELLS - position.numMoves() - 1 : 20;
+    int firstShared = 0;
+    if (numReplies > 0 && replies[0] == expected)
+    {
+        firstShared = 1;
+        for (int depth = 1; depth <= maxDepth; depth++)
+        {
+            if (!deepen(0, depth))
+            {
+                return;
+            }
+        }
+    }
+    for (int depth = 1; depth <= maxDepth; depth++)
+    {
+        for (int i = firstShared; i < numReplies; i++)
+        {
+            if (!deepen(i, depth))
+            {
+                return;
+            }
+        }
+    }
+}
+
+// the score pondering found for the current board, if it was one of the replies
+bool GameSession::ponderedScore(int &score) const
+{
+    bool isMirror = false;
+    uint64_t key = board.hash(isMirror);
+    for (int col = 0; col < Board::WIDTH; col++)
+    {
+        if (ponderKeys[col] != 0 && ponderKeys[col] == key)
+        {
+            score = ponderScores[col];
+            return true;
+        }
+    }
+    return false;
+}
+
+
+// number of table slots overwritten by a different position, over every search thread
+uint64_t GameSession::ttCollisions() const
+{
+    uint64_t total = searcher.ttCollisions;
+    for (const auto &helper : helpers)
+    {
+        total += helper->ttCollisions;
+    }
+    return total;
+}
+
+// number of table slots filled, over every search thread
+uint64_t GameSession::ttSize() const
+{
+    uint64_t total = searcher.ttSize;
+    for (const auto &helper : helpers)
+    {
+        total += helper->ttSize;
+    }
+    return total;
+}
+
+// make move helper function
+bool GameSession::makeMove(int col)
+{
+    return board.makeMove(col);
+}
+
+/* Replaces the current board with the position reached by a move history
+string such as "3342". The transposition table is left untouched so that
+a long-lived process keeps it warm between positions. Returns false (and
+leaves an empty board) if the history contains an illegal move; a history
+ending with the winning move is set up, and isGameOver() tells. */
+bool GameSession::setPosition(const std::string &history)
+{
+    strongSolver = false; // getAIMove switches it back on at Engine::STRONG_SOLVER_PLY
+    return Engine::parseHistory(history, board);
+}
+
+bool GameSession::isGameOver() const
+{
+    return board.checkWin();
+}
+
+// gets the move of the AI
+int GameSession::getAIMove(int initDepth, bool usingOldScoreFunction)
+{
+    stopPondering(); // the opponent has moved
+    prepareSearchers();
+    bool isMirror = false;
+    Board::Bitboard currentKey = board.canonicalKey(isMirror);
+    auto start = std::chrono::steady_clock::now();
+    nodesEvaluated = 0; // zero out the number of nodes each turn
+
+    // check the opening book for the best move for this board state
+    BookEntry bookEntry;
+    if (OpeningBook::SUPPORTED && engine.book().probe((uint64_t)currentKey, bookEntry))
+    {
+        // If the board was mirrored, we must flip the move!
+        int finalMove = isMirror ? (Board::WIDTH - 1 - bookEntry.move) : bookEntry.move;
+        if (engine.isVerbose())
+            std::cout << ">>> BOOK MOVE FOUND! Playing instantly. <<<\n";
+
+        lastScore = bookEntry.bound == OpeningBook::BOUND_NONE ? 0 : bookEntry.score;
+        lastBookMove = true;
+        lastProven = false; // book moves come from depth-limited searches
+        lastSearchTime = 0;
+        lastProbes = 0;
+        recordStats(start, false);
+        return finalMove;
+    }
+
+    // one ply before the score database, the children's exact scores decide
+    int databaseScore;
+    int databaseBest;
+    if (engine.databaseMove(board, databaseBest, databaseScore))
+    {
+        if (engine.isVerbose())
+            std::cout << ">>> EXACT SCORES FOUND! Playing instantly. <<<\n";
+
+        lastScore = databaseScore;
+        lastBookMove = false;
+        lastProven = true;
+        lastSearchTime = 0;
+        lastProbes = 0;
+        recordStats(start, false);
+        return databaseBest;
+    }
+
+    /* This is the implementation of iterative deepening. Primarily
+    helps make the transposition table more effective during the deepest
+    searches. */
+    int bestMove = Board::WIDTH / 2; // default move is the middle column
+    int currentScore = 0;
+    int maxDepth;
+
+    // Switch from heuristic solver to strong solver at a certain depth
+    if (board.numMoves() >= Engine::STRONG_SOLVER_PLY) // After 6 moves each (on 7x6), switch to strong solver that only evaluates wins and losses for faster deeper searches
+    {
+        if (!strongSolver && engine.isVerbose())
+        {
+            std::cout << "Switching to strong solver mode for deeper searches...\n";
+        }
+        maxDepth = initDepth - board.numMoves();
+        strongSolver = true;
+    }
+    else
+    {
+        maxDepth = 20;
+    }
+
+    searcher.strongSolver = strongSolver;
+    searcher.newSearch();
+    engine.applyLimits(searcher, start);
+    engine.table().newSearch();
+
+    if (strongSolver && engine.usesExactSolver())
+    {
+        return solvePosition(start);
+    }
+
+    // If pondering searched this reply, its deepest score is a far better first guess than 0
+    ponderedScore(currentScore);
+
+    /* Lazy SMP: every helper runs its own iterative deepening on the same
+    root and only communicates through the shared transposition table. Odd
+    helpers stay one ply ahead of the main thread, so the main thread keeps
+    finding their entries already waiting for it. Only the main thread's
+    result is used. */
+    std::atomic<bool> stopHelpers(false);
+    std::vector<std::thread> helperThreads;
+    for (size_t i = 0; i < helpers.size(); i++)
+    {
+        Searcher *helper = helpers[i].get();
+        helper->strongSolver = strongSolver;
+        helper->newSearch();
+        helper->setStopFlag(&stopHelpers);
+
+        Board root = board;
+        int firstDepth = 1 + (int)((i + 1) % 2);
+        helperThreads.emplace_back([helper, root, firstDepth, maxDepth, usingOldScoreFunction]()
+                                   {
+            int guess = 0;
+            for (int depth = firstDepth; depth <= maxDepth && !helper->wasStopped(); depth++)
+            {
+                guess = helper->MTD(root, guess, depth, usingOldScoreFunction).first;
+            } });
+    }
+
+    int completedDepth = 0;
+    for (int depth = 1; depth <= maxDepth; depth++)
+    {
+        auto result = searcher.MTD(board, currentScore, depth, usingOldScoreFunction);
+
+        // Out of time or nodes: keep the last completed depth's answer
+        if (searcher.wasStopped())
+        {
+            break;
+        }
+        completedDepth = depth;
+        currentScore = result.first;
+
+        // Grab the move directly (No flipping needed, MTD searches the actual board!)
+        if (result.second != -1)
+        {
+            bestMove = result.second;
+        }
+
+        if (!engine.isVerbose())
+        {
+            continue;
+        }
+
+        auto end = std::chrono::steady_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+
+        // prints status of the search for each depth
+        std::cout << "\r Depth: " << depth + board.numMoves() << " >> "
+                  << "| Search Time: " << duration.count() << "ms | "
+                  << "Nodes Evaluated: " << searcher.nodesEvaluated
+                  << " | TT Collisions: " << ttCollisions()
+                  << " | TT Space: " << std::fixed << std::setprecision(2) << 100.0 * ttSize() / engine.table().capacity() << "%"
+                  << " | First-move cutoffs: " << std::setprecision(1) << 100.0 * getFirstMoveCutoffRate() << "%"
+                  << " | Best move: " << bestMove << "     ";
+        std::cout.flush();
+    }
+    if (engine.isVerbose())
+        std::cout << "\n";
+
+    // The main thread has its answer, so the helpers can stop
+    stopHelpers = true;
+    for (auto &th : helperThreads)
+        th.join();
+
+    // Stopped before the first depth was done: no searched move at all
+    if (completedDepth == 0)
+    {
+        bestMove = searcher.fallbackMove(board);
+    }
+
+    nodesEvaluated = searcher.nodesEvaluated;
+    for (const auto &helper : helpers)
+    {
+        nodesEvaluated += helper->nodesEvaluated;
+    }
+
+    lastScore = currentScore;
+    lastBookMove = false;
+    lastProven = strongSolver && completedDepth == maxDepth; // the strong search reached the end of the game
+    lastSearchTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    lastProbes = 0;
+    recordStats(start, true);
+
+    return bestMove;
+};
+
+// scores every legal move of the current position on the main searcher
+MoveAnalysis GameSession::analyseMoves(bool exactScores)
+{
+    stopPondering();
+    prepareSearchers();
+    auto start = std::chrono::steady_clock::now();
+    engine.table().newSearch();
+    MoveAnalysis result = engine.analyseMoves(board, searcher, exactScores);
+
+    nodesEvaluated = result.nodes;
+    lastStats = searcher.stats;
+    lastStats.nodes = result.nodes;
+    lastStats.threads = 1;
+    lastStats.timeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (engine.printsStats())
+    {
+        std::cerr << lastStats.toJson() << std::endl;
+    }
+    return result;
+}
+
+/* Strong mode without iterative deepening: the solver bisects the score
+range directly. Helpers run the same bisection with their own move order
+and share bounds through the transposition table. */
+int GameSession::solvePosition(std::chrono::steady_clock::time_point start)
+{
+    std::atomic<bool> stopHelpers(false);
+    std::vector<std::thread> helperThreads;
+    for (const auto &helperPtr : helpers)
+    {
+        Searcher *helper = helperPtr.get();
+        helper->strongSolver = true;
+        helper->newSearch();
+        helper->setStopFlag(&stopHelpers);
+
+        Board root = board;
+        helperThreads.emplace_back([helper, root]()
+                                   { helper->solve(root); });
+    }
+
+    auto result = searcher.solve(board);
+
+    stopHelpers = true;
+    for (auto &th : helperThreads)
+        th.join();
+
+    nodesEvaluated = searcher.nodesEvaluated;
+    for (const auto &helper : helpers)
+    {
+        nodesEvaluated += helper->nodesEvaluated;
+    }
+
+    lastScore = result.first; // only a lower bound if a limit stopped the bisection
+    lastBookMove = false;
+    lastProven = !searcher.wasStopped();
+    lastSearchTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    lastProbes = searcher.solverProbes;
+    recordStats(start, true);
+
+    if (engine.isVerbose())
+    {
+        std::cout << " Exact score: " << lastScore
+                  << " | Probes: " << lastProbes
+                  << " | Search Time: " << lastSearchTime << "ms"
+                  << " | Nodes Evaluated: " << nodesEvaluated
+                  << " | Best move: " << result.second << "\n";
+    }
+
+    return result.second;
+}
+
+/* collects the stats of the search that just finished (all zero for a
+book move) and prints them if --stats asked for it */
+void GameSession::recordStats(std::chrono::steady_clock::time_point start, bool searched)
+{
+    lastStats.clear();
+    if (searched)
+    {
+        lastStats = searcher.stats;
+        for (const auto &helper : helpers)
+        {
+            lastStats.add(helper->stats);
+        }
+        lastStats.nodes = nodesEvaluated;
+        lastStats.threads = (int)helpers.size() + 1;
+    }
+    lastStats.timeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    if (engine.printsStats())
+    {
+        std::cerr << lastStats.toJson() << std::endl;
+    }
+}
+
+// fraction of the main thread's beta cutoffs that came from the first move searched
+double GameSession::getFirstMoveCutoffRate() const
+{
+    const SearchStats &stats = searcher.stats;
+    return stats.betaCutoffs ? (double)stats.cutoffsByMove[0] / stats.betaCutoffs : 0.0;
+}
+
+// gets the score of the most recent search (the book's score for book moves, 0 if it has none)
+int GameSession::getLastScore() const
+{
+    return lastScore;
+}
+
+// whether the most recent move came straight from the opening book
+bool GameSession::wasBookMove() const
+{
+    return lastBookMove;
+}
+
+// whether the most recent score is exact: a finished solve, not a heuristic, book or cut-short answer
+bool GameSession::wasProven() const
+{
+    return lastProven;
+}
+
+// gets the number of nodes evaluated by the most recent search
+uint64_t GameSession::getNodesEvaluated() const
+{
+    return nodesEvaluated;
+}
+
+// gets the wall-clock time of the most recent search in milliseconds
+long long GameSession::getLastSearchTime() const
+{
+    return lastSearchTime;
+}
+
+// gets the number of null-window probes the most recent exact solve needed
+int GameSession::getLastProbes() const
+{
+    return lastProbes;
+}
+
+// gets the telemetry of the most recent search
+const SearchStats &GameSession::getLastStats() const
+{
+    return lastStats;
+}
+
+// gets user input
+int GameSession::getHumanMove()
+{
+    int col;
+    while (true)
+    {
+        std::cout << "Enter your move (0-" << Board::WIDTH - 1 << "): ";
+        std::cin >> col;
+
+        // Check if the input is a valid number and a valid column
+        if (std::cin.fail() || col < 0 || col >= Board::WIDTH || !board.checkMove(col))
+        {
+            std::cin.clear();             // Clear the error flag
+            std::cin.ignore(10000, '\n'); // Throw away the bad input
+            std::cout << "Invalid move. Please try again.\n";
+        }
+        else
+        {
+            return col;
+        }
+    }
+}
+
+// runs the game
+void GameSession::startGame()
+{
+    std::cout << "=================================\n";
+    std::cout << "       C++ CONNECT FOUR AI       \n";
+    std::cout << "=================================\n";
+
+    board.displayBoard();
+
+    while (true)
+    {
+        int move;
+
+        // Player 1's turn (Even move count)
+        if (board.numMoves() % 2 == 0)
+        {
+            std::cout << "AI is thinking (X)...\n";
+            move = getAIMove(Board::CELLS, false);
+            std::cout << "\nAI chose column: " << move << "\n";
+        }
+        // Player 2's turn (Odd move count)
+        else
+        {
+            std::cout << "Player 1's Turn (O)\n";
+            move = getHumanMove();
+            stopPondering();
+            // move = getAIMove(Board::CELLS, true);
+        }
+
+        // Apply the move and show the board
+        board.makeMove(move);
+        board.displayBoard();
+
+        // Search the player's replies while they think
+        if (board.numMoves() % 2 == 1)
+        {
+            startPondering();
+        }
+
+        // Check for a winner (the player who JUST moved)
+        if (board.checkWin())
+        {
+            if (board.numMoves() % 2 == 1)
+            {
+                std::cout << "\n*** AI WINS! ***\n";
+            }
+            else
+            {
+                std::cout << "\n*** PLAYER 1 WINS! ***\n";
+            }
+        }
+        else if (board.numMoves() == Board::CELLS) // Check for a draw
+        {
+            std::cout << "\n*** IT'S A DRAW! ***\n";
+        }
+
+        // Ask if the player wants to play again
+        if (board.checkWin() || board.numMoves() == Board::CELLS)
+        {
+            if (!continueGame())
+            {
+                break;
+            }
+            else
+            {
+                std::cout << "\nStarting a new game...\n";
+                board = Board();      // Reset the board for a new game
+                strongSolver = false; // Reset strong solver mode for new game
+                engine.table().newGame();
+
+                board.displayBoard();
+            }
+        }
+    }
+}
+
+// asks the user if they want to play again
+bool GameSession::continueGame()
+{
+    char choice;
+    while (true)
+    {
+        std::cout << "Do you want to play again? (y/n): ";
+        std::cin >> choice;
+
+        if (choice == 'y' || choice == 'Y')
+        {
+            return true;
+        }
+        else if (choice == 'n' || choice == 'N')
+        {
+            return false;
+        }
+        else
+        {
+            std::cout << "Invalid input. Please enter 'y' or 'n'.\n";
+        }
+    }
+}
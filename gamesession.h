@@ -0,0 +1,97 @@
+#pragma once
+
+#include "board.h"
+#include "engine.h"
+#include "searcher.h"
+#include <iostream>
+#include <utility>       // Pair implementation for negamax return type
+#include <chrono>        // Time measurement
+#include <vector>
+#include <thread>
+#include <string>
+#include <memory>        // Lazy SMP helper searchers
+#include <atomic>
+
+/*
+
+One game played against the engine.
+
+A session holds the board, the searchers that work on it (the main one
+and its Lazy SMP helpers, each with its own history table and counters),
+the results of its last search and its ponder thread. The transposition
+table, the book, the score database and the settings belong to the
+Engine it was made from, so a session costs a few kilobytes and a
+process can keep one per connected client. Each session is used from one
+thread at a time; different sessions may search at the same time.
+
+*/
+
+class GameSession
+{
+private:
+    Engine &engine;
+    Board board;
+    int scorePlayer1;
+    int scorePlayer2;
+    uint64_t nodesEvaluated; // summed over every search thread
+
+    // Strong solver mode toggle
+    bool strongSolver = false;
+
+    // Results of the most recent getAIMove call
+    int lastScore;
+    bool lastBookMove;
+    long long lastSearchTime;
+    int lastProbes;
+    bool lastProven;
+    SearchStats lastStats;
+
+    // Main search thread, plus Lazy SMP helpers that share the engine's transposition table
+    Searcher searcher;
+    std::vector<std::unique_ptr<Searcher>> helpers;
+    void prepareSearchers();
+
+    /* Pondering: while the opponent thinks, the main searcher runs on a
+    background thread through their replies to the engine's move, filling
+    the shared table and leaving a first guess for the next search. */
+    std::thread ponderThread;
+    std::atomic<bool> stopPonder;
+    uint64_t ponderKeys[Board::WIDTH]; // hash of the position after each reply, 0 until a depth-limited search finished there
+    int ponderScores[Board::WIDTH];    // score of the deepest of those searches
+    void ponder(const Board position);
+    bool ponderedScore(int &score) const;
+
+    uint64_t ttCollisions() const; // summed over every search thread
+    uint64_t ttSize() const;
+    int solvePosition(std::chrono::steady_clock::time_point start);
+    void recordStats(std::chrono::steady_clock::time_point start, bool searched);
+
+public:
+    explicit GameSession(Engine &engine);
+    ~GameSession();
+    GameSession(const GameSession &) = delete;
+    GameSession &operator=(const GameSession &) = delete;
+
+    void startGame();
+    bool continueGame();
+    bool makeMove(int col);
+    bool setPosition(const std::string &history);
+    bool isGameOver() const; // the last move of the current position won the game
+    void startPondering(); // the opponent is to move on the current board
+    void stopPondering();
+    int getAIMove(int initDepth, bool usingOldScoreFunction);
+    int getHumanMove();
+
+    // Scores of every legal move of the current position from one search (hints)
+    MoveAnalysis analyseMoves(bool exactScores);
+
+    // Accessors for the most recent search
+    int getLastScore() const;
+    bool wasBookMove() const;
+    bool wasProven() const;
+    uint64_t getNodesEvaluated() const;
+    double getFirstMoveCutoffRate() const;
+    long long getLastSearchTime() const;
+    int getLastProbes() const;
+    const SearchStats &getLastStats() const;
+};
@@ -1,37 +1,69 @@
-
 from flask import Flask, request, jsonify
 from flask_cors import CORS
-import subprocess
+import threading
+import c4engine
 
 app = Flask(__name__)
-CORS(app) 
+CORS(app)
+
+# The engine runs inside this process through libc4engine (see c4engine.py):
+# the opening book, score database and transposition table are loaded once
+# and stay warm between requests, and the session ponders the player's
+# replies while they think.
+engine = None
+session = None
+engine_lock = threading.Lock()
+
+def get_session():
+    global engine, session
+    if session is None:
+        engine = c4engine.Engine(pondering=True)
+        engine.load_book('opening_book.bin')
+        engine.load_score_database('score_db.bin')
+        session = engine.session()
+    return session
 
 @app.route('/get_move', methods=['POST'])
 def get_move():
     data = request.json
     move_history = data.get('history', '')
-    
+
     try:
-        result = subprocess.run(
-            ['./engine.exe', '--api', move_history], 
-            capture_output=True, 
-            text=True,
-            check=True
-        )
-        
-        # THE FIX: Split the C++ output into a list of words, 
-        # and strictly grab the very last word (which will be the AI's move)
-        raw_output = result.stdout.strip().split()
-        ai_move = int(raw_output[-1]) 
-        
-        return jsonify({'ai_move': ai_move})
-        
+        with engine_lock:
+            result = get_session().solve(move_history)
+
+        return jsonify({'ai_move': result['move']})
+
+    except c4engine.C4Error as e:
+        if e.status in (c4engine.ILLEGAL_HISTORY, c4engine.BOARD_FULL, c4engine.GAME_OVER):
+            return jsonify({'error': str(e)}), 400
+        return jsonify({'error': str(e)}), 500
+
     except Exception as e:
-        # If it crashes again, this will print the exact C++ error to your browser console
-        error_details = result.stdout if 'result' in locals() else str(e)
-        return jsonify({'error': error_details}), 500
+        # If it crashes again, this will print the exact error to your browser console
+        return jsonify({'error': str(e)}), 500
         # file:///C:/Users/6stri/ConnectFour/index.html
 
+@app.route('/get_hints', methods=['POST'])
+def get_hints():
+    data = request.json
+    move_history = data.get('history', '')
+
+    try:
+        # One search scores every column (exact=False would only tell wins, draws and losses apart)
+        with engine_lock:
+            result = get_session().analyse(move_history)
+
+        return jsonify({'hints': result['moves'], 'proven': result['proven']})
+
+    except c4engine.C4Error as e:
+        if e.status in (c4engine.ILLEGAL_HISTORY, c4engine.BOARD_FULL, c4engine.GAME_OVER):
+            return jsonify({'error': str(e)}), 400
+        return jsonify({'error': str(e)}), 500
+
+    except Exception as e:
+        return jsonify({'error': str(e)}), 500
+
 if __name__ == '__main__':
     print("🚀 Connect Four API is running on http://localhost:5000")
     app.run(port=5000)
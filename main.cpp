@@ -1,15 +1,236 @@
-#include "connectfour.h"
+#include "engine.h"
+#include "gamesession.h"
+#include "server.h"
+#include "batch.h"
+#include "book.h"
+#include "boardkernels.h"
 #include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+// solves one position with 1, 2, 4, ... threads from a cold table and prints the speedup
+static void measureSpeedup(Engine &engine, const std::string &history, int maxThreads)
+{
+    long long baseTime = 0;
+    for (int threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        engine.setThreads(threads);
+        engine.clearTranspositionTable();
+        GameSession game(engine); // fresh searchers and counters for every run
+        game.setPosition(history);
+        int move = game.getAIMove(Board::CELLS, false);
+
+        long long time = std::max(1LL, game.getLastSearchTime());
+        if (threads == 1)
+        {
+            baseTime = time;
+        }
+        std::cout << "threads: " << std::setw(3) << threads
+                  << " | move: " << move
+                  << " | time: " << std::setw(7) << time << "ms"
+                  << " | nodes: " << std::setw(12) << game.getNodesEvaluated()
+                  << " | probes: " << std::setw(2) << game.getLastProbes()
+                  << " | first-move cutoffs: " << std::fixed << std::setprecision(1) << 100.0 * game.getFirstMoveCutoffRate() << "%"
+                  << " | speedup: " << std::fixed << std::setprecision(2) << (double)baseTime / time << "x\n";
+
+        if (threads < maxThreads && threads * 2 > maxThreads)
+        {
+            threads = maxThreads / 2; // always finish on the requested count
+        }
+    }
+}
 
 int main(int argc, char *argv[])
 {
-    ConnectFour game;
-    game.loadOpeningBook(); // Loads your 129,498 move masterpiece
+    // Options that apply to every mode, e.g. `./engine.exe --threads 8 --tt-mb 4096 --solver exact --serve`
+    int threads = 1;
+    long ttMegabytes = 0; // 0 keeps the default size
+    MoveOrdering ordering = MoveOrdering::Threats;
+    bool exactSolver = true;
+    bool incrementalEval = true;
+    bool stats = false;
+    long long moveTimeMs = 0; // 0 = no limit
+    uint64_t maxNodes = 0;
+    bool ponder = false;
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc)
+        {
+            threads = std::atoi(argv[++i]);
+        }
+        else if (arg == "--tt-mb" && i + 1 < argc)
+        {
+            ttMegabytes = std::atol(argv[++i]);
+        }
+        else if (arg == "--ordering" && i + 1 < argc)
+        {
+            ordering = std::string(argv[++i]) == "history" ? MoveOrdering::History : MoveOrdering::Threats;
+        }
+        else if (arg == "--eval" && i + 1 < argc)
+        {
+            incrementalEval = std::string(argv[++i]) != "full";
+        }
+        else if (arg == "--isa" && i + 1 < argc)
+        {
+            // Evaluation kernels are picked from CPUID; this forces a lower level, e.g. to compare them
+            std::string isa = argv[++i];
+            if (!selectBoardKernels(isa))
+            {
+                std::cerr << "Unknown or unsupported --isa " << isa << ", using " << boardKernels->name << "\n";
+            }
+        }
+        else if (arg == "--stats")
+        {
+            stats = true; // JSON search telemetry on stderr after every search
+        }
+        else if (arg == "--movetime" && i + 1 < argc)
+        {
+            moveTimeMs = std::atoll(argv[++i]); // per move, answers with the last completed depth when it runs out
+        }
+        else if (arg == "--nodes" && i + 1 < argc)
+        {
+            maxNodes = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--ponder")
+        {
+            ponder = true; // search the opponent's replies while they think (--serve and interactive play)
+        }
+        else if (arg == "--solver" && i + 1 < argc)
+        {
+            exactSolver = std::string(argv[++i]) != "iterative";
+        }
+        else
+        {
+            args.push_back(arg);
+        }
+    }
+
+    // CONVERTER: `./engine.exe --convert-book old_book.bin opening_book.bin`
+    if (args.size() >= 3 && args[0] == "--convert-book")
+    {
+        return OpeningBook::convertLegacy(args[1], args[2]) ? 0 : 1;
+    }
+
+    // Shared by every game this process plays; each game is a GameSession on top of it
+    Engine engine;
+    engine.setThreads(threads);
+    engine.setMoveOrdering(ordering);
+    engine.setExactSolver(exactSolver);
+    engine.setIncrementalEval(incrementalEval);
+    engine.setStatsOutput(stats);
+    engine.setLimits(moveTimeMs, maxNodes);
+    engine.setPondering(ponder);
+    if (ttMegabytes > 0)
+    {
+        engine.setTranspositionTableSize((size_t)ttMegabytes);
+    }
+
+    // SERVER MODE: `./engine.exe --serve` (stdin) or `./engine.exe --serve /tmp/c4.sock`
+    if (args.size() >= 1 && args[0] == "--serve")
+    {
+        engine.setVerbose(false); // stdout is the response channel
+        engine.loadOpeningBook();
+        engine.loadScoreDatabase();
+
+        if (args.size() >= 2)
+        {
+            return runSocketServer(engine, args[1]) ? 0 : 1;
+        }
+        GameSession game(engine);
+        runServer(game, std::cin, std::cout);
+        return 0;
+    }
+
+    // BATCH MODE: `./engine.exe --threads 8 --batch games.txt > results.jsonl` (stdin without a file)
+    if (args.size() >= 1 && args[0] == "--batch")
+    {
+        engine.setVerbose(false); // stdout is the result channel
+        engine.loadOpeningBook();
+        engine.loadScoreDatabase();
+
+        if (args.size() >= 2)
+        {
+            std::ifstream file(args[1]);
+            if (!file.is_open())
+            {
+                std::cerr << "Could not open " << args[1] << "\n";
+                return 1;
+            }
+            runBatch(engine, file, std::cout, threads);
+            return 0;
+        }
+        runBatch(engine, std::cin, std::cout, threads);
+        return 0;
+    }
+
+    // BOOK GENERATOR: `./engine.exe --threads 8 --build-book 8 20` solves every position up to ply 8 at depth 20
+    if (args.size() >= 3 && args[0] == "--build-book")
+    {
+        engine.buildOpeningBook(std::atoi(args[1].c_str()), std::atoi(args[2].c_str()), false, threads);
+        return 0;
+    }
+
+    // SCORE DATABASE: `./engine.exe --threads 8 --build-scoredb 12` solves every position at ply 12
+    // (`--build-scoredb 12 games.txt` only the positions of those move histories that are at ply 12)
+    if (args.size() >= 2 && args[0] == "--build-scoredb")
+    {
+        std::vector<std::string> histories;
+        if (args.size() >= 3)
+        {
+            std::ifstream file(args[2]);
+            if (!file.is_open())
+            {
+                std::cerr << "Could not open " << args[2] << "\n";
+                return 1;
+            }
+            for (std::string line; std::getline(file, line);)
+            {
+                histories.push_back(line.substr(0, line.find_first_of(" \t\r#")));
+            }
+        }
+        engine.buildScoreDatabase(std::atoi(args[1].c_str()), threads, args.size() >= 3 ? &histories : nullptr);
+        return 0;
+    }
+
+    // SPEEDUP REPORT: `./engine.exe --speedup 3333332224444 8`
+    if (args.size() >= 2 && args[0] == "--speedup")
+    {
+        engine.setVerbose(false);
+        int maxThreads = args.size() >= 3 ? std::atoi(args[2].c_str()) : (int)std::thread::hardware_concurrency();
+        measureSpeedup(engine, args[1], std::max(1, maxThreads));
+        return 0;
+    }
+
+    // ANALYSIS: `./engine.exe --analyse 333` prints the score and line of every legal move as JSON
+    // (`--analyse wdl 333` only as win, draw or loss)
+    if (args.size() >= 1 && args[0] == "--analyse")
+    {
+        engine.setVerbose(false);
+        engine.loadOpeningBook();
+        engine.loadScoreDatabase();
+        GameSession game(engine);
+        std::string request = "analyse";
+        for (size_t i = 1; i < args.size(); i++)
+        {
+            request += " " + args[i];
+        }
+        std::cout << handleServerRequest(game, request) << std::endl;
+        return 0;
+    }
 
     // API MODE: If we run `./engine.exe --api 333`
-    if (argc >= 3 && std::string(argv[1]) == "--api")
+    if (args.size() >= 2 && args[0] == "--api")
     {
-        std::string history = argv[2];
+        engine.setVerbose(false); // stdout carries nothing but the move (--stats goes to stderr)
+        engine.loadOpeningBook();
+        engine.loadScoreDatabase();
+        GameSession game(engine);
+        std::string history = args[1];
 
         // Replay the game history
         for (char c : history)
@@ -19,13 +240,16 @@ int main(int argc, char *argv[])
         }
 
         // Calculate the AI's response and print ONLY the number
-        int aiMove = game.getAIMove(42, false);
+        int aiMove = game.getAIMove(Board::CELLS, false);
         std::cout << aiMove << std::endl;
 
         return 0; // Shut down instantly
     }
 
     // NORMAL MODE: If we just run `./engine.exe`
+    engine.loadOpeningBook(); // Loads your 129,498 move masterpiece
+    engine.loadScoreDatabase();
+    GameSession game(engine);
     game.startGame();
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,133 @@
+#include "platform.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// asks the CPU (and, for AVX, the OS) which extensions can be used
+static CpuFeatures detectCpuFeatures()
+{
+    CpuFeatures features = {false, false, false};
+#if defined(C4_X86_64) && defined(_MSC_VER)
+    int regs[4];
+    __cpuid(regs, 1);
+    features.popcnt = (regs[2] >> 23) & 1;
+
+    // The OS must save the AVX (and AVX-512) register state on context switches
+    bool osAvx = ((regs[2] >> 27) & 1) && ((regs[2] >> 28) & 1) && (_xgetbv(0) & 0x6) == 0x6;
+    bool osAvx512 = osAvx && (_xgetbv(0) & 0xE6) == 0xE6;
+
+    __cpuidex(regs, 7, 0);
+    features.avx2 = osAvx && ((regs[1] >> 5) & 1);
+    features.avx512 = osAvx512 && ((regs[1] >> 16) & 1) && ((regs[2] >> 14) & 1);
+#elif defined(C4_X86_64) && defined(__GNUC__)
+    // These also check that the OS saves the vector registers
+    __builtin_cpu_init();
+    features.popcnt = __builtin_cpu_supports("popcnt");
+    features.avx2 = __builtin_cpu_supports("avx2");
+    features.avx512 = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vpopcntdq");
+#endif
+    return features;
+}
+
+const CpuFeatures &cpuFeatures()
+{
+    static const CpuFeatures features = detectCpuFeatures();
+    return features;
+}
+
+MappedFile::MappedFile() : view(nullptr), length(0)
+#ifdef _WIN32
+                           ,
+                           fileHandle(nullptr), mapHandle(nullptr)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+// maps the whole file, lookups will touch scattered pages so the OS is told not to read ahead
+bool MappedFile::open(const std::string &path)
+{
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(file, &fileSize);
+    HANDLE map = fileSize.QuadPart > 0 ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+    void *mapped = map ? MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!mapped)
+    {
+        if (map)
+            CloseHandle(map);
+        CloseHandle(file);
+        return false;
+    }
+
+    fileHandle = file;
+    mapHandle = map;
+    view = mapped;
+    length = (size_t)fileSize.QuadPart;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void *mapped = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // the mapping keeps the file alive
+    if (mapped == MAP_FAILED)
+    {
+        return false;
+    }
+    madvise(mapped, (size_t)st.st_size, MADV_RANDOM);
+
+    view = mapped;
+    length = (size_t)st.st_size;
+#endif
+    return true;
+}
+
+// unmaps the file
+void MappedFile::close()
+{
+    if (view)
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(view);
+        CloseHandle((HANDLE)mapHandle);
+        CloseHandle((HANDLE)fileHandle);
+        mapHandle = nullptr;
+        fileHandle = nullptr;
+#else
+        munmap(view, length);
+#endif
+    }
+    view = nullptr;
+    length = 0;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#if defined(_MSC_VER)
+#include <intrin.h> // __popcnt64, __cpuid, _mm_prefetch
+#endif
+
+/*
+
+Compiler and CPU portability layer. Everything else uses these helpers
+instead of compiler-specific intrinsics, so the engine builds with g++,
+clang and MSVC alike.
+
+The helpers compile to whatever the build targets: popcount64 is a
+single POPCNT instruction when the compiler may use it (-mpopcnt,
+-march=native, /arch:AVX) and a few bit tricks otherwise. The hot
+evaluation kernels do not rely on that; they are compiled for several
+instruction sets and picked at run time (see boardkernels.h).
+
+*/
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define C4_X86_64 1
+#endif
+
+// counts the set bits of x
+inline int popcount64(uint64_t x)
+{
+#if defined(__GNUC__) && defined(__POPCNT__)
+    return __builtin_popcountll(x);
+#elif defined(_MSC_VER) && defined(__AVX__)
+    return (int)__popcnt64(x); // MSVC only guarantees POPCNT with /arch:AVX or newer
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (int)((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// starts loading the cache line holding p
+inline void prefetch(const void *p)
+{
+#if defined(_MSC_VER)
+    _mm_prefetch((const char *)p, _MM_HINT_T0);
+#else
+    __builtin_prefetch(p);
+#endif
+}
+
+// instruction set extensions the running CPU (and OS) supports
+struct CpuFeatures
+{
+    bool popcnt;
+    bool avx2;
+    bool avx512; // AVX-512F with VPOPCNTDQ
+};
+
+const CpuFeatures &cpuFeatures();
+
+/* A whole file mapped read-only into memory. Nothing is copied or parsed
+when it opens, and every process mapping the same file shares its pages.
+Used for the opening book and the score database, which are binary
+searched in place. */
+class MappedFile
+{
+private:
+    void *view;
+    size_t length;
+#ifdef _WIN32
+    void *fileHandle;
+    void *mapHandle;
+#endif
+
+public:
+    MappedFile();
+    ~MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool open(const std::string &path); // false if missing or empty
+    void close();
+    const char *data() const { return (const char *)view; }
+    size_t size() const { return length; }
+};
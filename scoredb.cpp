@@ -0,0 +1,273 @@
+#include "scoredb.h"
+#include <algorithm> // sort, unique, upper_bound
+#include <cstdio>    // rename, remove
+#include <cstring>
+#include <fstream>
+
+static_assert(sizeof(ScoreDbHeader) == 56, "the score database header is 56 bytes on disk");
+
+// zero bytes after the bit stream, so a reader may always load 8 bytes at once
+static const size_t DATA_PADDING = 8;
+
+/* reads the bit stream written by BitWriter (bits < 57 at a time). Reading
+past the end of the stream yields zeros and sets overrun instead of
+touching memory beyond the padding. */
+struct BitReader
+{
+    const uint8_t *data;
+    uint64_t position; // in bits
+    uint64_t limit;    // bits in the stream
+    bool overrun;
+
+    uint64_t read(int bits)
+    {
+        if (position + bits > limit)
+        {
+            overrun = true;
+            position = limit;
+            return 0;
+        }
+        uint64_t window;
+        std::memcpy(&window, data + (position >> 3), sizeof(window)); // little-endian, like the writer
+        window >>= position & 7;
+        position += bits;
+        return bits ? window & (~0ULL >> (64 - bits)) : 0;
+    }
+
+    // counts the one bits before the next zero bit, and skips all of them
+    uint64_t readUnary()
+    {
+        uint64_t ones = 0;
+        while (!overrun && read(1))
+        {
+            ones++;
+        }
+        return ones;
+    }
+};
+
+// appends values to a little-endian bit stream, lowest bit first
+struct BitWriter
+{
+    std::vector<uint8_t> bytes;
+    uint64_t position = 0; // in bits
+
+    void write(uint64_t value, int bits)
+    {
+        for (int i = 0; i < bits; i++, position++)
+        {
+            if ((position >> 3) == bytes.size())
+            {
+                bytes.push_back(0);
+            }
+            bytes[position >> 3] |= (uint8_t)(((value >> i) & 1) << (position & 7));
+        }
+    }
+
+    void writeUnary(uint64_t count)
+    {
+        for (uint64_t i = 0; i < count; i++)
+        {
+            write(1, 1);
+        }
+        write(0, 1);
+    }
+};
+
+ScoreDatabase::ScoreDatabase() : header(nullptr), blocks(nullptr), data(nullptr), blockCount(0)
+{
+}
+
+// maps a score database file, false if it is missing or for another board
+bool ScoreDatabase::open(const std::string &path)
+{
+    close();
+    if (!SUPPORTED || !file.open(path))
+    {
+        return false;
+    }
+
+    const ScoreDbHeader *h = (const ScoreDbHeader *)file.data();
+    if (file.size() < sizeof(ScoreDbHeader) ||
+        std::memcmp(h->magic, "C4SD", 4) != 0 || h->version != VERSION ||
+        h->width != Board::WIDTH || h->height != Board::HEIGHT ||
+        h->blockSize == 0 || h->scoreBits > 16 || h->riceBits > 48)
+    {
+        close();
+        return false;
+    }
+
+    // The file must be exactly the header, index, data and padding
+    uint64_t blocksNeeded = h->count / h->blockSize + (h->count % h->blockSize != 0);
+    if (blocksNeeded > file.size() / sizeof(ScoreDbBlock) || h->dataBytes > file.size() ||
+        file.size() != sizeof(ScoreDbHeader) + blocksNeeded * sizeof(ScoreDbBlock) + h->dataBytes + DATA_PADDING)
+    {
+        close();
+        return false;
+    }
+
+    // Blocks must be sorted by key and start in order inside the data
+    const ScoreDbBlock *index = (const ScoreDbBlock *)(file.data() + sizeof(ScoreDbHeader));
+    for (size_t i = 0; i < blocksNeeded; i++)
+    {
+        if (index[i].bitOffset > h->dataBytes * 8 ||
+            (i > 0 && (index[i].firstKey <= index[i - 1].firstKey || index[i].bitOffset < index[i - 1].bitOffset)))
+        {
+            close();
+            return false;
+        }
+    }
+
+    header = h;
+    blocks = index;
+    data = (const uint8_t *)(index + blocksNeeded);
+    blockCount = (size_t)blocksNeeded;
+    return true;
+}
+
+// unmaps the database
+void ScoreDatabase::close()
+{
+    file.close();
+    header = nullptr;
+    blocks = nullptr;
+    data = nullptr;
+    blockCount = 0;
+}
+
+bool ScoreDatabase::isOpen() const
+{
+    return header != nullptr;
+}
+
+int ScoreDatabase::ply() const
+{
+    return header ? (int)header->ply : -1;
+}
+
+size_t ScoreDatabase::size() const
+{
+    return header ? (size_t)header->count : 0;
+}
+
+// looks up the exact score of a canonical position key
+bool ScoreDatabase::probe(uint64_t canonicalKey, int &score) const
+{
+    if (!header)
+    {
+        return false;
+    }
+
+    // The last block starting at or before the key
+    const ScoreDbBlock *block = std::upper_bound(blocks, blocks + blockCount, canonicalKey,
+                                                 [](uint64_t key, const ScoreDbBlock &b)
+                                                 { return key < b.firstKey; });
+    if (block == blocks)
+    {
+        return false;
+    }
+    block--;
+
+    size_t index = (size_t)(block - blocks) * header->blockSize;
+    size_t end = std::min((size_t)header->count, index + header->blockSize);
+    BitReader reader = {data, block->bitOffset, header->dataBytes * 8, false};
+
+    uint64_t key = block->firstKey;
+    int stored = (int)reader.read(header->scoreBits);
+    while (key < canonicalKey && ++index < end)
+    {
+        uint64_t delta = (reader.readUnary() << header->riceBits) | reader.read(header->riceBits);
+        key += delta + 1;
+        stored = (int)reader.read(header->scoreBits);
+    }
+
+    if (reader.overrun || key != canonicalKey)
+    {
+        return false;
+    }
+    score = stored + header->minScore;
+    return true;
+}
+
+/* Sorts the entries and writes a version 2 database. The Rice parameter is
+picked from the average key gap, which keeps the unary part of a delta
+at one or two bits. */
+bool ScoreDatabase::write(const std::string &path, int ply, std::vector<std::pair<uint64_t, int>> entries)
+{
+    std::sort(entries.begin(), entries.end());
+    entries.erase(std::unique(entries.begin(), entries.end(), [](const std::pair<uint64_t, int> &a, const std::pair<uint64_t, int> &b)
+                              { return a.first == b.first; }),
+                  entries.end());
+
+    ScoreDbHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "C4SD", 4);
+    header.version = VERSION;
+    header.width = Board::WIDTH;
+    header.height = Board::HEIGHT;
+    header.ply = (uint32_t)ply;
+    header.blockSize = BLOCK_SIZE;
+    header.count = entries.size();
+
+    int minScore = 0, maxScore = 0;
+    for (const auto &entry : entries)
+    {
+        minScore = std::min(minScore, entry.second);
+        maxScore = std::max(maxScore, entry.second);
+    }
+    header.minScore = minScore;
+    while ((1 << header.scoreBits) <= maxScore - minScore)
+    {
+        header.scoreBits++;
+    }
+
+    if (entries.size() > 1)
+    {
+        uint64_t meanGap = (entries.back().first - entries.front().first) / (entries.size() - 1);
+        while (header.riceBits < 48 && (2ULL << header.riceBits) <= meanGap)
+        {
+            header.riceBits++;
+        }
+    }
+
+    std::vector<ScoreDbBlock> index;
+    BitWriter writer;
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        if (i % BLOCK_SIZE == 0)
+        {
+            index.push_back({entries[i].first, writer.position});
+        }
+        else
+        {
+            uint64_t delta = entries[i].first - entries[i - 1].first - 1;
+            writer.writeUnary(delta >> header.riceBits);
+            writer.write(delta, header.riceBits);
+        }
+        writer.write((uint64_t)(entries[i].second - minScore), header.scoreBits);
+    }
+    header.dataBytes = writer.bytes.size();
+    writer.bytes.resize(writer.bytes.size() + DATA_PADDING, 0);
+
+    // Written next to the old file and renamed over it, like the book
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream outFile(tempPath, std::ios::binary | std::ios::trunc);
+        if (!outFile.is_open())
+        {
+            return false;
+        }
+        outFile.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        outFile.write(reinterpret_cast<const char *>(index.data()), index.size() * sizeof(ScoreDbBlock));
+        outFile.write(reinterpret_cast<const char *>(writer.bytes.data()), writer.bytes.size());
+        if (!outFile)
+        {
+            return false;
+        }
+    }
+
+#ifdef _WIN32
+    std::remove(path.c_str()); // rename does not replace existing files on Windows
+#endif
+    return std::rename(tempPath.c_str(), path.c_str()) == 0;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "board.h"
+#include "platform.h"
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+
+Exact score database (score_db.bin): the solved score of every canonical
+position at one ply, past the end of the opening book. The search treats
+a hit as a proven result, so positions before that ply no longer need
+to be searched down to it and beyond.
+
+File format (version 2):
+
+  ScoreDbHeader (56 bytes)
+  ScoreDbBlock index[blockCount]   first key of every block of blockSize entries
+  uint8_t data[dataBytes]          the blocks, as one little-endian bit stream
+  uint8_t padding[8]               zero
+
+The entries are sorted by canonical key. A block stores its first score,
+then for every further entry the key delta minus one as a Rice code
+(unary quotient, riceBits low bits) followed by the score. Scores are
+stored as score - minScore in scoreBits bits, 5 bits at ply 12 on the
+standard board. Consecutive canonical keys are close together, so an
+entry takes a handful of bits instead of the 16 bytes of a book entry.
+
+A lookup binary searches the index and decodes at most one block. The
+file is memory-mapped like the book, so nothing is loaded at start-up.
+Its size must match the header exactly and the index must be sorted and
+point inside the data, and decoding never reads past the data, so a
+truncated or corrupted file is rejected instead of yielding scores.
+
+*/
+
+struct ScoreDbHeader
+{
+    char magic[4];      // "C4SD"
+    uint32_t version;   // 2
+    uint32_t width;     // board columns
+    uint32_t height;    // board rows
+    uint32_t ply;       // pieces on the board of every stored position
+    int32_t minScore;   // scores are stored relative to this
+    uint32_t scoreBits; // bits per stored score
+    uint32_t riceBits;  // low bits of a key delta's Rice code
+    uint32_t blockSize; // entries per index block
+    uint32_t reserved;  // zero
+    uint64_t count;     // number of entries
+    uint64_t dataBytes; // length of the bit stream, without the padding
+};
+
+struct ScoreDbBlock
+{
+    uint64_t firstKey;  // key of the block's first entry
+    uint64_t bitOffset; // where the block starts in the data
+};
+
+class ScoreDatabase
+{
+private:
+    MappedFile file;
+    const ScoreDbHeader *header;
+    const ScoreDbBlock *blocks;
+    const uint8_t *data;
+    size_t blockCount;
+
+public:
+    static const uint32_t VERSION = 2;
+    static const uint32_t BLOCK_SIZE = 64;
+    static const bool SUPPORTED = Board::KEY_BITS <= 64; // keys of this board size fit the index
+
+    ScoreDatabase();
+    bool open(const std::string &path);
+    void close();
+    bool isOpen() const;
+    int ply() const; // -1 while closed
+    size_t size() const;
+
+    bool probe(uint64_t canonicalKey, int &score) const;
+
+    // entries: canonical key, exact score; sorted and deduplicated here
+    static bool write(const std::string &path, int ply, std::vector<std::pair<uint64_t, int>> entries);
+};
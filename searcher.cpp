@@ -0,0 +1,1125 @@
+#include "searcher.h"
+#include <algorithm> // max
+#include <chrono>
+#include <cstdlib>   // abs
+
+static_assert(Board::WIDTH < TT_NO_MOVE, "columns must fit the transposition table's move field");
+
+// sets up a searcher, helpers (id > 0) get a slightly different move order
+Searcher::Searcher(TranspositionTable &table, int id) : transpositionTable(table),
+                                                       stopFlag(nullptr), stopped(false), nodeLimit(UINT64_MAX), hasDeadline(false), nextClockCheck(0),
+                                                       book(nullptr), bookMaxPly(-1), scoreDb(nullptr), scoreDbPly(-1), rootPly(0),
+                                                       nodesEvaluated(0), ttCollisions(0), ttSize(0),
+                                                       solverProbes(0),
+                                                       strongSolver(false), ordering(MoveOrdering::Threats),
+                                                       incrementalEval(true)
+{
+    const int W = Board::WIDTH;
+
+    /* Center columns first (ties go left), and a default history that
+    falls off by 10 per column away from the middle: {3, 2, 4, 1, 5, 0, 6}
+    and {0, 10, 20, 30, 20, 10, 0} on a 7-wide board. */
+    int defaultOrder[Board::WIDTH];
+    for (int j = 0; j < W; j++)
+    {
+        defaultOrder[j] = j;
+    }
+    std::stable_sort(defaultOrder, defaultOrder + W, [W](int a, int b)
+                     { return std::abs(2 * a - (W - 1)) < std::abs(2 * b - (W - 1)); });
+
+    for (int i = 0; i < 2; i++)
+    {
+        for (int j = 0; j < W; j++)
+        {
+            historyHeuristic[i][j] = 10 * ((W - 1) / 2 - std::abs(2 * j - (W - 1)) / 2); // Initialize history heuristic to default values
+        }
+    }
+
+    /* Lazy SMP helpers search the same tree as the main thread. Giving each
+    one its own tie-break order and a little history noise sends them down
+    different branches first, so they fill the shared table with entries the
+    main thread has not reached yet. */
+    for (int j = 0; j < W; j++)
+    {
+        moveOrder[j] = defaultOrder[j];
+    }
+    for (int ply = 0; ply <= Board::CELLS; ply++)
+    {
+        killerMoves[ply][0] = -1;
+        killerMoves[ply][1] = -1;
+    }
+    if (id > 0)
+    {
+        std::rotate(moveOrder + 1, moveOrder + 1 + (id % (W - 1)), moveOrder + W); // keep the center first
+        uint32_t seed = 2654435761u * (uint32_t)id;
+        for (int i = 0; i < 2; i++)
+        {
+            for (int j = 0; j < W; j++)
+            {
+                seed = seed * 1664525u + 1013904223u;
+                historyHeuristic[i][j] += (int)(seed >> 28); // 0-15
+            }
+        }
+    }
+}
+
+/* prepares for a new search from a new root: clears the counters and
+killer moves, and halves the history scores so that what was learned in
+earlier positions fades instead of piling up for the whole process. */
+void Searcher::newSearch()
+{
+    nodesEvaluated = 0;
+    stopped = false;
+    nextClockCheck = 0;
+    bookMaxPly = book && book->isOpen() ? book->maxPly() : -1;
+    scoreDbPly = scoreDb ? scoreDb->ply() : -1;
+    stats.clear();
+
+    for (int i = 0; i < 2; i++)
+    {
+        for (int j = 0; j < Board::WIDTH; j++)
+        {
+            historyHeuristic[i][j] /= 2;
+        }
+    }
+    for (int ply = 0; ply <= Board::CELLS; ply++)
+    {
+        killerMoves[ply][0] = -1;
+        killerMoves[ply][1] = -1;
+    }
+}
+
+// makes negamax return early once the flag is set
+void Searcher::setStopFlag(const std::atomic<bool> *flag)
+{
+    stopFlag = flag;
+    stopped = false;
+}
+
+// whether the last search was cut short by the stop flag
+bool Searcher::wasStopped() const
+{
+    return stopped;
+}
+
+// lets negamax answer positions inside the book's ply range from its scored entries
+void Searcher::setBook(const OpeningBook *openingBook)
+{
+    book = openingBook;
+}
+
+// lets both searches answer positions at the database's ply with their exact scores
+void Searcher::setScoreDatabase(const ScoreDatabase *database)
+{
+    scoreDb = database;
+}
+
+/* converts an exact score (the solver's scale: positive wins, larger is
+sooner) into what negamax would return for that position with depth
+plies left: +-(1000 + depth - plies to the winning move), 0 for a draw */
+static int exactToNegamax(int exact, int ply, int depth)
+{
+    if (exact == 0)
+    {
+        return 0;
+    }
+
+    // The winner's last stone goes in after winMoves stones: (CELLS + 1 - winMoves) / 2 = |exact|
+    int magnitude = exact > 0 ? exact : -exact;
+    int winMoves = Board::CELLS + 1 - 2 * magnitude;
+    bool winnerMovesNow = exact > 0;
+    if ((winMoves % 2 == ply % 2) != winnerMovesNow)
+    {
+        winMoves--; // integer division dropped the half
+    }
+    int value = 1000 + depth - (winMoves - ply + 1);
+    return exact > 0 ? value : -value;
+}
+
+/* limits the next searches to a number of nodes and a point in time.
+Once either runs out, negamax and solveNegamax unwind like they do for the
+stop flag and the caller keeps its last complete result. */
+void Searcher::setLimits(uint64_t maxNodes, std::chrono::steady_clock::time_point stopTime)
+{
+    nodeLimit = maxNodes ? maxNodes : UINT64_MAX;
+    hasDeadline = stopTime != std::chrono::steady_clock::time_point::max();
+    deadline = stopTime;
+}
+
+/* whether the search must unwind now. The clock is only read once every
+1024 nodes, so the check costs a few compares per node. */
+inline bool Searcher::shouldStop()
+{
+    if (stopped || (stopFlag && stopFlag->load(std::memory_order_relaxed)) || nodesEvaluated >= nodeLimit)
+    {
+        stopped = true;
+    }
+    else if (hasDeadline && nodesEvaluated >= nextClockCheck)
+    {
+        nextClockCheck = nodesEvaluated + 1024;
+        stopped = std::chrono::steady_clock::now() >= deadline;
+    }
+    return stopped;
+}
+
+/* picks a move without searching: a move that does not lose on the spot
+(any legal move if there is none) creating the most winning cells, center
+first on ties. Used when a limit stops the search before it has a result. */
+int Searcher::fallbackMove(const Board &board) const
+{
+    Board::Bitboard next = board.possibleNonLosingMoves();
+    if (next == 0)
+    {
+        next = board.possible();
+    }
+
+    int bestMove = -1;
+    int bestThreats = -1;
+    for (int col : moveOrder)
+    {
+        if ((next & Board::columnMask(col)) && board.threatsAfterMove(col) > bestThreats)
+        {
+            bestMove = col;
+            bestThreats = board.threatsAfterMove(col);
+        }
+    }
+    return bestMove;
+}
+
+/* what negamax would return for a depth-0 child that cannot have been
+won: a stored score if it is exact or cuts off the window, then a proven
+database score, then a book score that is exact or cuts off the window,
+otherwise the static evaluation */
+int Searcher::leafScore(const LeafResult &leaf, int alpha, int beta)
+{
+    if (leaf.ttHit)
+    {
+        if (leaf.tt.flag == 0)
+        {
+            stats.ttCutoffs++;
+            return leaf.tt.score;
+        }
+        if (leaf.tt.flag == 1 && leaf.tt.score > alpha)
+        {
+            alpha = leaf.tt.score;
+        }
+        if (leaf.tt.flag == 2 && leaf.tt.score < beta)
+        {
+            beta = leaf.tt.score;
+        }
+        if (alpha >= beta)
+        {
+            stats.ttCutoffs++;
+            return leaf.tt.score;
+        }
+    }
+    if (leaf.dbHit)
+    {
+        stats.dbHits++;
+        return leaf.dbScore;
+    }
+    if (leaf.bookHit)
+    {
+        const BookEntry &entry = leaf.bookEntry;
+        if (entry.bound == OpeningBook::BOUND_EXACT ||
+            (entry.bound == OpeningBook::BOUND_LOWER && entry.score >= beta) ||
+            (entry.bound == OpeningBook::BOUND_UPPER && entry.score <= alpha))
+        {
+            stats.bookHits++;
+            return entry.score;
+        }
+    }
+    return leaf.staticScore;
+}
+
+// determines best possible move
+std::pair<int, int> Searcher::negamax(const Board board, int depth, int alpha, int beta, bool usingOldScoreFunction)
+{
+    // Unwinds once the search must end: its stop flag was raised (the main thread
+    // has its answer, or a ponder was cancelled) or --movetime / --nodes ran out
+    if (shouldStop())
+    {
+        return {0, -1};
+    }
+
+    // Store initial alpha value for transposition table flag determination
+    int originalAlpha = alpha;
+
+    // Increments the number of nodes evaluated
+    nodesEvaluated++;
+
+    // Checks the mirror state of the board for the transposition table
+    bool isMirror = false;
+
+    uint64_t boardHash = board.hash(isMirror);
+
+    int ttBestMove = -1;
+    TTData tt;
+
+    stats.ttProbes++;
+    if (transpositionTable.probe(boardHash, tt))
+    {
+        stats.ttHits++;
+        if (tt.move != TT_NO_MOVE)
+        {
+            ttBestMove = isMirror ? (Board::WIDTH - 1 - tt.move) : tt.move;
+        }
+
+        if (tt.depth >= depth)
+        {
+            if (tt.flag == 0)
+            {
+                stats.ttCutoffs++;
+                return {tt.score, ttBestMove}; // Exact Match
+            }
+            if (tt.flag == 1 && tt.score > alpha)
+            {
+                alpha = tt.score; // Lower Bound
+            }
+            if (tt.flag == 2 && tt.score < beta)
+            {
+                beta = tt.score; // Upper Bound
+            }
+            if (alpha >= beta)
+            {
+                stats.ttCutoffs++;
+                return {tt.score, ttBestMove}; // Cutoff!
+            }
+        }
+    }
+
+    /* First base case is to check for a win.
+    This will also prioritize wins that occur
+    sooner. */
+    if (board.checkWin())
+    {
+        return {-1000 - depth, -1};
+    }
+
+    // A proven score for every position at the database's ply
+    if (board.numMoves() == scoreDbPly && scoreDbPly != rootPly)
+    {
+        bool dbMirror = false;
+        int exact;
+        stats.dbProbes++;
+        if (scoreDb->probe((uint64_t)board.canonicalKey(dbMirror), exact))
+        {
+            stats.dbHits++;
+            return {exactToNegamax(exact, board.numMoves(), depth), -1};
+        }
+    }
+
+    /* Inside the book's ply range, an entry searched at least as deep
+    answers the node like a table hit. Its scores are heuristic ones,
+    so the strong solver never uses them. */
+    if (board.numMoves() <= bookMaxPly && !strongSolver && !usingOldScoreFunction)
+    {
+        bool bookMirror = false;
+        BookEntry entry;
+        stats.bookProbes++;
+        if (book->probe((uint64_t)board.canonicalKey(bookMirror), entry) && entry.bound != OpeningBook::BOUND_NONE && entry.depth >= depth)
+        {
+            int bookMove = bookMirror ? (Board::WIDTH - 1 - entry.move) : entry.move;
+            if (entry.bound == OpeningBook::BOUND_EXACT ||
+                (entry.bound == OpeningBook::BOUND_LOWER && entry.score >= beta) ||
+                (entry.bound == OpeningBook::BOUND_UPPER && entry.score <= alpha))
+            {
+                stats.bookHits++;
+                return {entry.score, bookMove};
+            }
+        }
+    }
+
+    /* Second base case is to exit if the board
+    is full and return nothing. */
+    if ((board.numMoves() == Board::CELLS || depth == 0) && !strongSolver)
+    {
+        if (!usingOldScoreFunction)
+        {
+            // use the new, improved score function for the new brain
+            return {incrementalEval ? board.incrementalScore() : board.score(), -1};
+        }
+        else
+        {
+            return {board.oldScore(), -1}; // use the old, naive score function for the old brain (for testing purposes)
+        }
+    }
+    else if ((board.numMoves() == Board::CELLS || depth == 0) && strongSolver)
+    {
+        return {0, -1}; // strong solver only evaluates wins and losses
+    }
+
+    /* Immediate win: return what searching the winning child would give
+    (its checkWin at depth - 1) without making the move. */
+    Board::Bitboard possibleMask = board.possible();
+    Board::Bitboard winningMoves = board.winningPositions() & possibleMask;
+    if (winningMoves)
+    {
+        for (int col : moveOrder)
+        {
+            if (winningMoves & Board::columnMask(col))
+            {
+                return {1000 + depth - 1, col};
+            }
+        }
+    }
+
+    /* With two or more plies left, moves that let the opponent win next
+    turn are never better than any other move, so only search the rest. If
+    every move loses, the score is what any of them would get: the opponent
+    wins one ply below the child (-(1000 + depth - 2)). */
+    Board::Bitboard allowedMoves = possibleMask;
+    if (depth >= 2)
+    {
+        allowedMoves = board.possibleNonLosingMoves();
+        if (allowedMoves == 0)
+        {
+            return {-(1000 + depth - 2), -1};
+        }
+    }
+
+    // Initialize score and move
+    int bestScore = -9999;
+    int bestMove = -1;
+
+    // History heuristic move ordering
+    int currentPlayer = board.numMoves() % 2; // 0 for player 1, 1 for player 2
+
+    /* Create a vecotr to prioritize the most
+    likely best moves first. */
+    // int columnSearchOrder[7] = {3, 2, 4, 1, 5, 0, 6};
+
+    // Order the moves to prioritize the most likely best moves first
+    int bestColumnSearchOrder[Board::WIDTH];
+    int numBestMoves = 0;
+
+    if (ttBestMove != -1 && (allowedMoves & Board::columnMask(ttBestMove)))
+    {
+        bestColumnSearchOrder[numBestMoves++] = ttBestMove;
+    }
+
+    int remainingMoves[Board::WIDTH];
+    int numRemaining = 0;
+
+    for (int col : moveOrder)
+    {
+        if (col != ttBestMove && (allowedMoves & Board::columnMask(col)))
+        {
+            remainingMoves[numRemaining++] = col;
+        }
+    }
+
+    /* Score every remaining move. History mode uses the history heuristic.
+    Threat mode prefers moves that create the most new winning cells, and
+    breaks ties with this ply's killer moves (moves that caused a cutoff in
+    a sibling position). */
+    int ply = board.numMoves();
+    int moveScores[Board::WIDTH];
+    for (int i = 0; i < numRemaining; ++i)
+    {
+        int col = remainingMoves[i];
+        if (ordering == MoveOrdering::Threats)
+        {
+            int killerBonus = (col == killerMoves[ply][0]) ? 2 : (col == killerMoves[ply][1]) ? 1 : 0;
+            moveScores[i] = board.threatsAfterMove(col) * 4 + killerBonus;
+        }
+        else
+        {
+            moveScores[i] = historyHeuristic[currentPlayer][col];
+        }
+    }
+
+    // Insertion Sort based on the move scores (stable, so ties keep the center-first order)
+    for (int i = 1; i < numRemaining; ++i)
+    {
+        int keyMove = remainingMoves[i];
+        int keyScore = moveScores[i];
+        int j = i - 1;
+
+        // Move elements that have a smaller score down the line
+        while (j >= 0 && moveScores[j] < keyScore)
+        {
+            remainingMoves[j + 1] = remainingMoves[j];
+            moveScores[j + 1] = moveScores[j];
+            j = j - 1;
+        }
+        remainingMoves[j + 1] = keyMove;
+        moveScores[j + 1] = keyScore;
+    }
+
+    for (int i = 0; i < numRemaining; ++i)
+    {
+        bestColumnSearchOrder[numBestMoves++] = remainingMoves[i];
+    }
+
+    // Start pulling every child's bucket into cache before the first recursion
+    Board children[Board::WIDTH];
+    for (int i = 0; i < numBestMoves; i++)
+    {
+        children[i] = board;
+        children[i].makeMove(bestColumnSearchOrder[i]);
+        bool childMirror;
+        transpositionTable.prefetch(children[i].hash(childMirror));
+    }
+
+    /* One ply above the heuristic horizon every child is a leaf, so they
+    are scored here instead of recursing into each. The first child usually
+    cuts off on its own, so it is scored alone; the rest are scored in one
+    batched evaluation only if it does not. Their table entries are still
+    probed, because a leaf returns a stored score when it is exact or cuts
+    off its window, and the score database and book are probed just as
+    negamax probes them. */
+    LeafResult leaves[Board::WIDTH];
+    bool batchedLeaves = depth == 1 && !strongSolver && !usingOldScoreFunction && incrementalEval;
+    auto prepareLeaves = [&](int first, int count)
+    {
+        int staticScores[Board::WIDTH];
+        Board::scoreBatch(children + first, count, staticScores);
+        for (int j = 0; j < count; j++)
+        {
+            bool childMirror;
+            leaves[first + j].staticScore = staticScores[j];
+            leaves[first + j].ttHit = transpositionTable.probe(children[first + j].hash(childMirror), leaves[first + j].tt);
+            stats.ttProbes++;
+            stats.ttHits += leaves[first + j].ttHit;
+
+            // The same database and book probes negamax makes, so both eval modes search one tree
+            leaves[first + j].dbHit = false;
+            if (children[first + j].numMoves() == scoreDbPly)
+            {
+                bool dbMirror = false;
+                int exact;
+                stats.dbProbes++;
+                if (scoreDb->probe((uint64_t)children[first + j].canonicalKey(dbMirror), exact))
+                {
+                    leaves[first + j].dbHit = true;
+                    leaves[first + j].dbScore = exactToNegamax(exact, children[first + j].numMoves(), 0);
+                }
+            }
+
+            // Every stored depth covers a leaf, so any bounded entry may answer it
+            leaves[first + j].bookHit = false;
+            if (children[first + j].numMoves() <= bookMaxPly)
+            {
+                bool bookMirror = false;
+                stats.bookProbes++;
+                leaves[first + j].bookHit = book->probe((uint64_t)children[first + j].canonicalKey(bookMirror), leaves[first + j].bookEntry) &&
+                                            leaves[first + j].bookEntry.bound != OpeningBook::BOUND_NONE;
+            }
+        }
+    };
+
+    // Principle Variation Search with alpha-beta pruning
+    bool firstMove = true;
+
+    /* Iterate through the moves and determine
+    best move. */
+    for (int i = 0; i < numBestMoves; i++)
+    {
+        int col = bestColumnSearchOrder[i]; // Get the clean, sorted column
+
+        if (board.checkMove(col))
+        {
+            const Board &nextBoard = children[i];
+
+            if (batchedLeaves && i <= 1)
+            {
+                prepareLeaves(i, i == 0 ? 1 : numBestMoves - 1);
+            }
+
+            // Searches the child, or resolves it from the batched leaf scores
+            auto searchChild = [&](int childDepth, int childAlpha, int childBeta)
+            {
+                if (batchedLeaves)
+                {
+                    nodesEvaluated++;
+                    return leafScore(leaves[i], childAlpha, childBeta);
+                }
+                return negamax(nextBoard, childDepth, childAlpha, childBeta, usingOldScoreFunction).first;
+            };
+
+            /* This is the recursive part. It filps the value
+            of the score so that it is always the opposite of
+            the best move the opponent can get. */
+            int score;
+            if (firstMove) // PVS assumes the first move is the best
+            {
+                score = -searchChild(depth - 1, -beta, -alpha);
+                firstMove = false;
+            }
+            else
+            {
+                int reduction = 0;
+                if (i >= 3 && depth >= 4)
+                {
+                    reduction = 1; // Reduce search by 1 full ply
+                }
+
+                // Will only search with a narrow window if it is not the first move
+                score = -searchChild(depth - 1 - reduction, -alpha - 1, -alpha);
+
+                if (reduction > 0 && score > alpha)
+                {
+                    stats.lmrResearches++;
+                    score = -searchChild(depth - 1, -alpha - 1, -alpha);
+                }
+                // If the score is between alpha and beta, we need to re-search with the full window
+                if (score > alpha && score < beta)
+                {
+                    stats.pvsResearches++;
+                    score = -searchChild(depth - 1, -beta, -score);
+                }
+            }
+
+            // An aborted subtree returns garbage, so unwind without touching the TT
+            if (stopped)
+            {
+                return {0, -1};
+            }
+
+            if (score > bestScore)
+            {
+                bestScore = score;
+                bestMove = col;
+            }
+
+            // alpha-beta pruning implementation
+            if (bestScore > alpha)
+            {
+                alpha = bestScore;
+            }
+            if (alpha >= beta) // opponent won't let this move happen
+            {
+                /* Update history heuristic for move ordering (tries to make a
+                trap for the opponent by making this move more likely to be searched
+                earlier in the future). */
+                historyHeuristic[currentPlayer][col] += depth * depth; // More depth = more valuable move
+
+                // Remember the move as a killer for sibling positions at this ply
+                if (killerMoves[ply][0] != col)
+                {
+                    killerMoves[ply][1] = killerMoves[ply][0];
+                    killerMoves[ply][0] = col;
+                }
+
+                stats.betaCutoffs++;
+                stats.cutoffsByMove[i]++;
+
+                break;
+            }
+        }
+    }
+
+    int flagToSave = 0;
+    if (bestScore <= originalAlpha)
+    {
+        flagToSave = 2; // Upper Bound
+    }
+    else if (bestScore >= beta)
+    {
+        flagToSave = 1; // Lower Bound
+    }
+
+    int moveToSave = (bestMove == -1) ? TT_NO_MOVE : (isMirror ? (Board::WIDTH - 1 - bestMove) : bestMove);
+
+    // The table picks the slot within the bucket (depth and age aware)
+    TranspositionTable::StoreResult stored = transpositionTable.store(boardHash, bestScore, depth, moveToSave, flagToSave);
+    if (stored == TranspositionTable::FILLED_EMPTY)
+    {
+        ttSize++;
+    }
+    else if (stored == TranspositionTable::REPLACED_OTHER)
+    {
+        ttCollisions++;
+    }
+
+    return {bestScore, bestMove};
+};
+
+// searches a small window to make large alpha-beta cutoffs early into search
+std::pair<int, int> Searcher::MTD(Board currentBoard, int firstGuess, int depth, bool usingOldScoreFunction)
+{
+    int guess = firstGuess;
+    int upperBound = 9999;
+    int lowerBound = -9999;
+    int bestMove = -1;
+    rootPly = currentBoard.numMoves(); // the root needs a move, which the score database cannot give
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t startNodes = nodesEvaluated;
+    int passes = 0;
+
+    while (lowerBound < upperBound)
+    {
+        int beta = std::max(guess, lowerBound + 1);
+        auto result = negamax(currentBoard, depth, beta - 1, beta, usingOldScoreFunction);
+        passes++;
+        if (stopped)
+        {
+            break;
+        }
+        guess = result.first;
+
+        // Secure the best move directly
+        if (result.second != -1)
+        {
+            bestMove = result.second;
+        }
+
+        if (beta > guess)
+        {
+            upperBound = guess;
+        }
+        else
+        {
+            lowerBound = guess;
+        }
+    }
+
+    double timeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    stats.depths.push_back({depth, passes, guess, nodesEvaluated - startNodes, timeMs});
+    return {guess, bestMove};
+}
+
+// Solver entries are keyed apart from depth-limited entries, whose scores mean something else
+static const uint64_t SOLVER_SALT = 0x9E3779B97F4A7C15ULL;
+
+/* Exact negamax for the solver. The caller guarantees that the player to
+move cannot win immediately. Returns a fail-soft score and the move that
+produced it (-1 if no move beat alpha). */
+std::pair<int, int> Searcher::solveNegamax(const Board &board, int alpha, int beta)
+{
+    // Unwinds once the search must end: its stop flag was raised (the main thread
+    // has its answer, or a ponder was cancelled) or --movetime / --nodes ran out
+    if (shouldStop())
+    {
+        return {0, -1};
+    }
+
+    nodesEvaluated++;
+    int moves = board.numMoves();
+
+    // Every move hands the opponent a win: they win with their next stone
+    Board::Bitboard next = board.possibleNonLosingMoves();
+    if (next == 0)
+    {
+        return {-(Board::CELLS - moves) / 2, -1};
+    }
+
+    // With two cells left and no loss in sight, neither side can win
+    if (moves >= Board::CELLS - 2)
+    {
+        return {0, -1};
+    }
+
+    if (moves == scoreDbPly && moves != rootPly)
+    {
+        bool dbMirror = false;
+        int exact;
+        stats.dbProbes++;
+        if (scoreDb->probe((uint64_t)board.canonicalKey(dbMirror), exact))
+        {
+            stats.dbHits++;
+            return {exact, -1};
+        }
+    }
+
+    // We cannot win before our second move from now, or lose before the opponent's
+    int minScore = -(Board::CELLS - 2 - moves) / 2;
+    int maxScore = (Board::CELLS - 1 - moves) / 2;
+
+    bool isMirror = false;
+    uint64_t boardHash = board.hash(isMirror) ^ SOLVER_SALT;
+    int ttBestMove = -1;
+    TTData tt;
+
+    stats.ttProbes++;
+    bool ttHit = transpositionTable.probe(boardHash, tt);
+    if (ttHit)
+    {
+        stats.ttHits++;
+        if (tt.move != TT_NO_MOVE)
+        {
+            ttBestMove = isMirror ? (Board::WIDTH - 1 - tt.move) : tt.move;
+        }
+        if (tt.flag == 1 && tt.score > minScore)
+        {
+            minScore = tt.score; // Lower Bound
+        }
+        else if (tt.flag == 2 && tt.score < maxScore)
+        {
+            maxScore = tt.score; // Upper Bound
+        }
+    }
+
+    if (alpha < minScore)
+    {
+        alpha = minScore;
+        if (alpha >= beta)
+        {
+            stats.ttCutoffs += ttHit;
+            return {alpha, ttBestMove};
+        }
+    }
+    if (beta > maxScore)
+    {
+        beta = maxScore;
+        if (alpha >= beta)
+        {
+            stats.ttCutoffs += ttHit;
+            return {beta, ttBestMove};
+        }
+    }
+
+    // TT move first, then the moves that create the most winning cells
+    int order[Board::WIDTH];
+    int scores[Board::WIDTH];
+    int numMoves = 0;
+    for (int col : moveOrder)
+    {
+        if (next & Board::columnMask(col))
+        {
+            int score = (col == ttBestMove) ? 1000 : board.threatsAfterMove(col);
+            int j = numMoves++;
+            while (j > 0 && scores[j - 1] < score)
+            {
+                order[j] = order[j - 1];
+                scores[j] = scores[j - 1];
+                j--;
+            }
+            order[j] = col;
+            scores[j] = score;
+        }
+    }
+
+    for (int i = 0; i < numMoves; i++)
+    {
+        Board child = board;
+        child.makeMove(order[i]);
+        bool childMirror;
+        transpositionTable.prefetch(child.hash(childMirror) ^ SOLVER_SALT);
+    }
+
+    int bestScore = -1000;
+    int bestMove = -1;
+
+    for (int i = 0; i < numMoves; i++)
+    {
+        Board nextBoard = board;
+        nextBoard.makeMove(order[i]);
+        int score = -solveNegamax(nextBoard, -beta, -alpha).first;
+
+        if (stopped)
+        {
+            return {0, -1};
+        }
+
+        if (score > bestScore)
+        {
+            bestScore = score;
+            bestMove = order[i];
+        }
+        if (score >= beta)
+        {
+            stats.betaCutoffs++;
+            stats.cutoffsByMove[i]++;
+            int moveToSave = isMirror ? (Board::WIDTH - 1 - bestMove) : bestMove;
+            transpositionTable.store(boardHash, score, Board::CELLS - moves, moveToSave, 1); // Lower Bound
+            return {score, bestMove};
+        }
+        if (score > alpha)
+        {
+            alpha = score;
+        }
+    }
+
+    // No move reached beta, so the best score is an upper bound
+    int moveToSave = (bestMove == -1) ? TT_NO_MOVE : (isMirror ? (Board::WIDTH - 1 - bestMove) : bestMove);
+    transpositionTable.store(boardHash, bestScore, Board::CELLS - moves, moveToSave, 2);
+    return {bestScore, bestMove};
+}
+
+/* Narrows [minScore, maxScore] with null-window probes until it holds
+only the exact score of a position without an immediate win, or a limit
+stops it. Without a guess the range is bisected; with one, every probe
+tests the score just found, the way MTD(f) walks from its first guess,
+which takes two probes when the guess is right. Returns the move that
+proved the last lower bound, -1 if no probe raised it. */
+int Searcher::bisect(const Board &board, int &minScore, int &maxScore, bool fromGuess, int guess)
+{
+    int bestMove = -1;
+    while (minScore < maxScore)
+    {
+        int med = minScore + (maxScore - minScore) / 2;
+        if (fromGuess)
+        {
+            med = std::min(std::max(guess, minScore), maxScore - 1);
+        }
+        else if (med <= 0 && minScore / 2 < med)
+        {
+            med = minScore / 2;
+        }
+        else if (med >= 0 && maxScore / 2 > med)
+        {
+            med = maxScore / 2;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        uint64_t startNodes = nodesEvaluated;
+        auto result = solveNegamax(board, med, med + 1);
+        solverProbes++;
+        double timeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        stats.probes.push_back({med, result.first, nodesEvaluated - startNodes, timeMs});
+        if (stopped)
+        {
+            break;
+        }
+
+        if (result.first <= med)
+        {
+            maxScore = result.first;
+            guess = result.first - 1;
+        }
+        else
+        {
+            minScore = result.first;
+            guess = result.first;
+            bestMove = result.second; // this move scores at least the new lower bound
+        }
+    }
+    return bestMove;
+}
+
+/* Finds the exact score by bisecting the score range with null-window
+searches (see bisect). Each probe only answers "is the score above med?",
+which is far cheaper than a full-window search, and the window is split
+towards zero first because most positions are close to a draw. */
+std::pair<int, int> Searcher::solve(const Board &board)
+{
+    solverProbes = 0;
+    int moves = board.numMoves();
+
+    // solveNegamax assumes there is no immediate win
+    Board::Bitboard winningMoves = board.winningPositions() & board.possible();
+    if (winningMoves)
+    {
+        for (int col : moveOrder)
+        {
+            if (winningMoves & Board::columnMask(col))
+            {
+                return {(Board::CELLS + 1 - moves) / 2, col};
+            }
+        }
+    }
+
+    int minScore = -(Board::CELLS - moves) / 2;
+    int maxScore = (Board::CELLS + 1 - moves) / 2;
+    rootPly = moves;
+
+    // A root in the score database has a known score: one probe just below it finds the move
+    if (moves == scoreDbPly)
+    {
+        int exact;
+        bool dbMirror = false;
+        stats.dbProbes++;
+        if (scoreDb->probe((uint64_t)board.canonicalKey(dbMirror), exact))
+        {
+            stats.dbHits++;
+            minScore = exact - 1;
+            maxScore = exact;
+        }
+    }
+
+    int bestMove = bisect(board, minScore, maxScore, false, 0);
+
+    // Cut short before any probe proved a move: best guess, the score is only a lower bound
+    if (bestMove == -1 && stopped)
+    {
+        return {minScore, fallbackMove(board)};
+    }
+
+    // Never proved better than the minimum: every move loses as fast as possible
+    if (bestMove == -1)
+    {
+        Board::Bitboard next = board.possibleNonLosingMoves();
+        for (int col : moveOrder)
+        {
+            if ((next ? next : board.possible()) & Board::columnMask(col))
+            {
+                bestMove = col;
+                break;
+            }
+        }
+    }
+
+    return {minScore, bestMove};
+}
+
+// orders root moves by score, best first (a bound counts as its value)
+static bool betterRootMove(const RootMove &a, const RootMove &b)
+{
+    return a.score > b.score;
+}
+
+/* Scores every legal move, from the position after it. Siblings tend to
+score alike, so every move after the first is probed from the best score
+found so far (see bisect), and all of them share what the others left
+in the table. Without exact scores, every range is cut to [-1, 1], so at
+most two probes prove a move a win (a lower bound of at least 1), a draw
+or a loss (an upper bound of at most -1). Moves are returned best first
+(see betterRootMove), ties in move order. */
+std::vector<RootMove> Searcher::solveMoves(const Board &board, bool exactScores)
+{
+    solverProbes = 0;
+    int moves = board.numMoves();
+    rootPly = moves;
+    bool haveBest = false;
+    int bestScore = 0;
+
+    std::vector<RootMove> rootMoves;
+    for (int col : moveOrder)
+    {
+        if (!board.checkMove(col))
+        {
+            continue;
+        }
+
+        RootMove rootMove = {col, 0, ScoreBound::Exact, {}};
+        Board child = board;
+        child.makeMove(col);
+        if (child.checkWin())
+        {
+            rootMove.score = (Board::CELLS + 1 - moves) / 2;
+        }
+        else if (child.canWinNext())
+        {
+            rootMove.score = -(Board::CELLS - moves) / 2; // the opponent wins with their next stone
+        }
+        else
+        {
+            // The opponent's score after the move
+            int lowest = -(Board::CELLS - 1 - moves) / 2;
+            int highest = (Board::CELLS - moves) / 2;
+            int minScore = exactScores ? lowest : std::max(lowest, -1);
+            int maxScore = exactScores ? highest : std::min(highest, 1);
+            int firstMin = minScore;
+            int firstMax = maxScore;
+            bisect(child, minScore, maxScore, haveBest, -bestScore);
+
+            // An end of the range no probe moved is only proven if it was not cut
+            int opponentMin = minScore == firstMin ? lowest : minScore;
+            int opponentMax = maxScore == firstMax ? highest : maxScore;
+            if (opponentMin == opponentMax)
+            {
+                rootMove.score = -opponentMin;
+            }
+            else if (opponentMax <= -1)
+            {
+                rootMove.score = -opponentMax; // we win
+                rootMove.bound = ScoreBound::Lower;
+            }
+            else
+            {
+                rootMove.score = -opponentMin; // the opponent wins, or a limit stopped the probes
+                rootMove.bound = ScoreBound::Upper;
+            }
+        }
+
+        if (!haveBest || rootMove.score > bestScore)
+        {
+            haveBest = true;
+            bestScore = rootMove.score;
+        }
+        rootMove.pv = principalVariation(board, col, true);
+        rootMoves.push_back(rootMove);
+    }
+
+    std::stable_sort(rootMoves.begin(), rootMoves.end(), betterRootMove);
+    return rootMoves;
+}
+
+/* Scores every legal move at the depth the root was just searched to:
+each child gets an MTD search one ply shallower, started from the root
+score, which finds the root search's bounds for it in the table. */
+std::vector<RootMove> Searcher::searchMoves(const Board &board, int depth, int rootScore, int rootMove, bool usingOldScoreFunction)
+{
+    std::vector<RootMove> rootMoves;
+    for (int col : moveOrder)
+    {
+        if (!board.checkMove(col))
+        {
+            continue;
+        }
+
+        RootMove scored = {col, rootScore, ScoreBound::Exact, {}};
+        if (col != rootMove)
+        {
+            Board child = board;
+            child.makeMove(col);
+            int childScore = MTD(child, -rootScore, depth - 1, usingOldScoreFunction).first;
+            if (stopped)
+            {
+                scored.bound = ScoreBound::Upper; // no move beats the root's best
+            }
+            else
+            {
+                scored.score = -childScore;
+            }
+        }
+        scored.pv = principalVariation(board, col, false);
+        rootMoves.push_back(scored);
+    }
+    rootPly = board.numMoves();
+
+    std::stable_sort(rootMoves.begin(), rootMoves.end(), betterRootMove);
+    return rootMoves;
+}
+
+/* plays move, then follows the best moves stored in the table (the
+solver's entries if exact) until the game ends or the table has none.
+An immediate win is always played, so a won line ends with its winning move. */
+std::vector<int> Searcher::principalVariation(Board board, int move, bool exact) const
+{
+    std::vector<int> pv;
+    while (move != -1)
+    {
+        pv.push_back(move);
+        board.makeMove(move);
+        if (board.checkWin() || board.numMoves() == Board::CELLS)
+        {
+            break;
+        }
+
+        move = -1;
+        Board::Bitboard winningMoves = board.winningPositions() & board.possible();
+        for (int col : moveOrder)
+        {
+            if (winningMoves & Board::columnMask(col))
+            {
+                move = col;
+                break;
+            }
+        }
+        if (move != -1)
+        {
+            continue;
+        }
+
+        move = tableMove(board, exact);
+    }
+    return pv;
+}
+
+// the best move the table holds for a position (the solver's entry if exact), -1 if none
+int Searcher::tableMove(const Board &board, bool exact) const
+{
+    bool isMirror = false;
+    uint64_t boardHash = board.hash(isMirror) ^ (exact ? SOLVER_SALT : 0);
+    TTData tt;
+    if (!transpositionTable.probe(boardHash, tt) || tt.move == TT_NO_MOVE)
+    {
+        return -1;
+    }
+    int col = isMirror ? (Board::WIDTH - 1 - tt.move) : tt.move;
+    return board.checkMove(col) ? col : -1; // another position may have overwritten the entry
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "board.h"
+#include "book.h"
+#include "scoredb.h"
+#include "searchstats.h"
+#include "transpositiontable.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <utility> // Pair implementation for negamax return type
+#include <vector>
+
+/*
+
+One search thread. Holds everything negamax mutates while it runs
+(node counters, history heuristic, move order) so that several searchers
+can work on the same root at once. The only shared state is the
+transposition table, which every searcher reads and writes without locks.
+
+*/
+
+// how negamax orders the moves it has no transposition table move for
+enum class MoveOrdering
+{
+    History, // history heuristic scores
+    Threats  // number of winning cells a move creates, then killer moves
+};
+
+// how a root move's score relates to its true value
+enum class ScoreBound
+{
+    Exact,
+    Lower, // the move scores at least this
+    Upper  // the move scores at most this
+};
+
+// one legal root move scored by solveMoves or searchMoves
+struct RootMove
+{
+    int move;
+    int score;
+    ScoreBound bound;
+    std::vector<int> pv; // starts with move, read back from the transposition table
+};
+
+class Searcher
+{
+private:
+    TranspositionTable &transpositionTable;
+
+    // Set by the main thread to end a helper search, nullptr for the main searcher
+    const std::atomic<bool> *stopFlag;
+    bool stopped;
+
+    // Search limits (setLimits), checked together with the stop flag
+    uint64_t nodeLimit; // UINT64_MAX when unlimited
+    bool hasDeadline;
+    std::chrono::steady_clock::time_point deadline;
+    uint64_t nextClockCheck; // node count at which the deadline is next checked
+    bool shouldStop();
+
+    // Opening book probed at interior nodes up to its deepest ply (-1 while there is none)
+    const OpeningBook *book;
+    int bookMaxPly;
+
+    // Exact scores probed at the one ply the database covers (-1 while there is none), except at the root
+    const ScoreDatabase *scoreDb;
+    int scoreDbPly;
+    int rootPly;
+
+    // a depth-0 child of a batched depth-1 node
+    struct LeafResult
+    {
+        int staticScore;
+        bool ttHit;
+        TTData tt;
+        bool dbHit;  // proven score from the score database at its ply
+        int dbScore; // already converted to a negamax score
+        bool bookHit; // book entry with a usable bound
+        BookEntry bookEntry;
+    };
+    int leafScore(const LeafResult &leaf, int alpha, int beta);
+
+    int bisect(const Board &board, int &minScore, int &maxScore, bool fromGuess, int guess); // narrows the range to the exact score, returns the move proving the lower bound
+
+public:
+    uint64_t nodesEvaluated;
+
+    // Tracks transposition table hits and misses
+    uint64_t ttCollisions;
+    uint64_t ttSize;
+
+    // Null-window searches used by the last exact solve
+    int solverProbes;
+
+    // Counters of the current search (cleared by newSearch)
+    SearchStats stats;
+
+    // Strong solver mode toggle
+    bool strongSolver;
+
+    // Determines move ordering based on the history heuristic
+    int historyHeuristic[2][Board::WIDTH]; // [player][column] for move ordering
+    int moveOrder[Board::WIDTH];           // column order before history sorting
+    int killerMoves[Board::CELLS + 1][2];  // [ply][slot] last two moves that caused a cutoff
+    MoveOrdering ordering;
+    bool incrementalEval; // leaves use Board::incrementalScore instead of Board::score (same values)
+
+    Searcher(TranspositionTable &table, int id);
+    void newSearch();
+    void setStopFlag(const std::atomic<bool> *flag);
+    void setBook(const OpeningBook *openingBook); // read at every newSearch, so it may be opened or closed later
+    void setScoreDatabase(const ScoreDatabase *database); // likewise
+    void setLimits(uint64_t maxNodes, std::chrono::steady_clock::time_point stopTime); // 0 nodes / time_point::max() = none
+    bool wasStopped() const; // the last search was cut short by the stop flag or a limit
+    int fallbackMove(const Board &board) const; // cheap best guess for when no search result is available
+
+    std::pair<int, int> negamax(const Board board, int depth, int alpha, int beta, bool usingOldScoreFunction);
+    // Memory-Enhanced Test Driver - searches the tree with a minimal window to get a better score estimate for the next search
+    std::pair<int, int> MTD(Board currentBoard, int firstGuess, int depth, bool usingOldScoreFunction);
+
+    /* Exact solver. Scores are game-theoretic: 0 for a draw, otherwise
+    positive if the player to move wins and larger the sooner they win.
+    A win with the player's k-th remaining stone scores (CELLS + 1 - n) / 2 - k + 1
+    where n is the number of pieces on the board, so every score lies in
+    [-(CELLS - n) / 2, (CELLS - n) / 2] (CELLS = 42 on the standard board). */
+    std::pair<int, int> solveNegamax(const Board &board, int alpha, int beta);
+    std::pair<int, int> solve(const Board &board);
+
+    /* Multi-PV: scores every legal move of the root, best first, in one
+    search on one table, exactly or only as win, draw or loss. A move a
+    limit did not leave time for keeps the bound found so far.
+    searchMoves does the same for the depth-limited search once the root
+    has been searched to depth. */
+    std::vector<RootMove> solveMoves(const Board &board, bool exactScores);
+    std::vector<RootMove> searchMoves(const Board &board, int depth, int rootScore, int rootMove, bool usingOldScoreFunction);
+    std::vector<int> principalVariation(Board board, int move, bool exact) const; // move, then the table's best moves
+    int tableMove(const Board &board, bool exact) const;
+};
@@ -0,0 +1,90 @@
+#include "searchstats.h"
+#include <iomanip>
+#include <sstream>
+
+SearchStats::SearchStats()
+{
+    clear();
+}
+
+// zeroes every counter and forgets the depths and probes
+void SearchStats::clear()
+{
+    nodes = 0;
+    timeMs = 0;
+    threads = 1;
+    ttProbes = 0;
+    ttHits = 0;
+    ttCutoffs = 0;
+    bookProbes = 0;
+    bookHits = 0;
+    dbProbes = 0;
+    dbHits = 0;
+    betaCutoffs = 0;
+    for (uint64_t &count : cutoffsByMove)
+    {
+        count = 0;
+    }
+    pvsResearches = 0;
+    lmrResearches = 0;
+    depths.clear();
+    probes.clear();
+}
+
+// adds another thread's counters (not its depths or probes)
+void SearchStats::add(const SearchStats &other)
+{
+    ttProbes += other.ttProbes;
+    ttHits += other.ttHits;
+    ttCutoffs += other.ttCutoffs;
+    bookProbes += other.bookProbes;
+    bookHits += other.bookHits;
+    dbProbes += other.dbProbes;
+    dbHits += other.dbHits;
+    betaCutoffs += other.betaCutoffs;
+    for (int i = 0; i < Board::WIDTH; i++)
+    {
+        cutoffsByMove[i] += other.cutoffsByMove[i];
+    }
+    pvsResearches += other.pvsResearches;
+    lmrResearches += other.lmrResearches;
+}
+
+// formats the stats as a single line of JSON
+std::string SearchStats::toJson() const
+{
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3);
+    out << "{\"nodes\":" << nodes
+        << ",\"time_ms\":" << timeMs
+        << ",\"nps\":" << (timeMs > 0 ? (uint64_t)(nodes / timeMs * 1000.0) : 0)
+        << ",\"threads\":" << threads
+        << ",\"tt\":{\"probes\":" << ttProbes << ",\"hits\":" << ttHits << ",\"cutoffs\":" << ttCutoffs
+        << ",\"hit_rate\":" << (ttProbes ? (double)ttHits / ttProbes : 0.0) << "}"
+        << ",\"book\":{\"probes\":" << bookProbes << ",\"hits\":" << bookHits << "}"
+        << ",\"score_db\":{\"probes\":" << dbProbes << ",\"hits\":" << dbHits << "}"
+        << ",\"beta_cutoffs\":" << betaCutoffs
+        << ",\"cutoffs_by_move\":[";
+    for (int i = 0; i < Board::WIDTH; i++)
+    {
+        out << (i ? "," : "") << cutoffsByMove[i];
+    }
+    out << "],\"pvs_researches\":" << pvsResearches
+        << ",\"lmr_researches\":" << lmrResearches
+        << ",\"depths\":[";
+    for (size_t i = 0; i < depths.size(); i++)
+    {
+        const DepthStats &d = depths[i];
+        out << (i ? "," : "") << "{\"depth\":" << d.depth << ",\"mtd_passes\":" << d.mtdPasses
+            << ",\"score\":" << d.score << ",\"nodes\":" << d.nodes << ",\"time_ms\":" << d.timeMs << "}";
+    }
+    out << "],\"probes\":[";
+    for (size_t i = 0; i < probes.size(); i++)
+    {
+        const ProbeStats &p = probes[i];
+        out << (i ? "," : "") << "{\"window\":" << p.window << ",\"score\":" << p.score
+            << ",\"nodes\":" << p.nodes << ",\"time_ms\":" << p.timeMs << "}";
+    }
+    out << "]}";
+    return out.str();
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "board.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+
+Telemetry of one search, for finding out why a position is slow.
+
+Every Searcher fills its own SearchStats as it goes. The counters are
+plain increments on data the searcher already owns, so they are always
+on; nothing is formatted or written unless someone asks for the JSON
+(--stats prints it to stderr after every search, and the server answers
+a "stats" request with the last one).
+
+*/
+
+// one iterative deepening step: an MTD(f) search to a fixed depth
+struct DepthStats
+{
+    int depth;
+    int mtdPasses; // null-window negamax calls MTD needed to converge
+    int score;
+    uint64_t nodes;
+    double timeMs;
+};
+
+// one null-window probe of the exact solver
+struct ProbeStats
+{
+    int window; // tests whether the score is above this value
+    int score;  // fail-soft result
+    uint64_t nodes;
+    double timeMs;
+};
+
+struct SearchStats
+{
+    // Filled in by whoever runs the search, summed over every thread
+    uint64_t nodes;
+    double timeMs;
+    int threads;
+
+    uint64_t ttProbes;
+    uint64_t ttHits;    // probes that found an entry for the position
+    uint64_t ttCutoffs; // hits that answered the node without searching it
+
+    uint64_t bookProbes; // interior nodes looked up in the opening book
+    uint64_t bookHits;   // lookups that answered the node
+    uint64_t dbProbes;   // nodes looked up in the exact score database
+    uint64_t dbHits;
+
+    uint64_t betaCutoffs;
+    uint64_t cutoffsByMove[Board::WIDTH]; // beta cutoffs by the index of the move that caused them
+
+    uint64_t pvsResearches; // null-window searches that failed high and were searched again with the full window
+    uint64_t lmrResearches; // reduced searches that beat alpha and were searched again at full depth
+
+    // Main thread only
+    std::vector<DepthStats> depths;
+    std::vector<ProbeStats> probes;
+
+    SearchStats();
+    void clear();
+    void add(const SearchStats &other); // adds another thread's counters (not its depths or probes)
+    std::string toJson() const;
+};
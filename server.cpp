@@ -0,0 +1,229 @@
+#include "server.h"
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <thread>
+#include <functional> // ref
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <csignal>
+#include <cstring>
+#endif
+
+// formats a multi-PV analysis as one JSON line
+static std::string analysisJson(const MoveAnalysis &analysis)
+{
+    std::ostringstream response;
+    response << "{\"moves\":[";
+    for (size_t i = 0; i < analysis.moves.size(); i++)
+    {
+        const RootMove &move = analysis.moves[i];
+        const char *bound = move.bound == ScoreBound::Exact ? "exact" : (move.bound == ScoreBound::Lower ? "lower" : "upper");
+        response << (i ? "," : "") << "{\"move\":" << move.move
+                 << ",\"score\":" << move.score
+                 << ",\"bound\":\"" << bound << "\",\"pv\":\"";
+        for (int col : move.pv)
+        {
+            response << col;
+        }
+        response << "\"}";
+    }
+    response << "],\"proven\":" << (analysis.proven ? "true" : "false")
+             << ",\"nodes\":" << analysis.nodes
+             << ",\"time_ms\":" << analysis.timeMs << "}";
+    return response.str();
+}
+
+// answers a single request line, returns an empty string for "quit"
+std::string handleServerRequest(GameSession &game, const std::string &line)
+{
+    // strip the carriage return left behind by Windows clients
+    std::string history = line;
+    while (!history.empty() && (history.back() == '\r' || history.back() == ' '))
+    {
+        history.pop_back();
+    }
+
+    if (history == "quit")
+    {
+        return "";
+    }
+
+    if (history == "stats")
+    {
+        return game.getLastStats().toJson();
+    }
+
+    // "analyse 3342" scores every move instead of picking one, "analyse wdl 3342" only as win, draw or loss
+    std::istringstream words(history);
+    std::string word;
+    bool analyse = words >> word && word == "analyse";
+    bool exactScores = true;
+    if (analyse)
+    {
+        history.clear();
+        if (words >> history && history == "wdl")
+        {
+            exactScores = false;
+            history.clear();
+            words >> history;
+        }
+    }
+
+    if (!game.setPosition(history))
+    {
+        return "{\"error\":\"illegal move history\"}";
+    }
+    if (game.isGameOver())
+    {
+        return "{\"error\":\"game is over\"}";
+    }
+    if (history.size() >= (size_t)Board::CELLS)
+    {
+        return "{\"error\":\"board is full\"}";
+    }
+
+    if (analyse)
+    {
+        return analysisJson(game.analyseMoves(exactScores));
+    }
+
+    int move = game.getAIMove(Board::CELLS, false);
+
+    std::ostringstream response;
+    response << "{\"move\":" << move
+             << ",\"score\":" << game.getLastScore()
+             << ",\"book\":" << (game.wasBookMove() ? "true" : "false")
+             << ",\"proven\":" << (game.wasProven() ? "true" : "false")
+             << ",\"nodes\":" << game.getNodesEvaluated()
+             << ",\"time_ms\":" << game.getLastSearchTime() << "}";
+
+    // With --ponder, the replies to this move are searched until the next request comes in
+    game.makeMove(move);
+    game.startPondering();
+    return response.str();
+}
+
+// serves requests from a stream (stdin) until EOF or "quit"
+void runServer(GameSession &game, std::istream &in, std::ostream &out)
+{
+    std::string line;
+    while (std::getline(in, line))
+    {
+        std::string response = handleServerRequest(game, line);
+        if (response.empty())
+        {
+            break;
+        }
+        out << response << std::endl; // flush so the client sees every answer immediately
+    }
+}
+
+#ifndef _WIN32
+
+// writes a whole buffer to a socket, retrying on short writes; fails with
+// EPIPE once the client has hung up, which closes just that connection
+static bool writeAll(int fd, const std::string &data)
+{
+    size_t written = 0;
+    while (written < data.size())
+    {
+        ssize_t n = write(fd, data.data() + written, data.size() - written);
+        if (n <= 0)
+        {
+            return false;
+        }
+        written += (size_t)n;
+    }
+    return true;
+}
+
+// answers one client until it disconnects or sends "quit", with a session of its own
+static void serveConnection(Engine &engine, int clientFd)
+{
+    GameSession game(engine);
+
+    // Split the byte stream into lines and answer each one in order
+    std::string pending;
+    char buffer[4096];
+    bool open = true;
+    while (open)
+    {
+        ssize_t n = read(clientFd, buffer, sizeof(buffer));
+        if (n <= 0)
+        {
+            break;
+        }
+        pending.append(buffer, (size_t)n);
+
+        size_t newline;
+        while (open && (newline = pending.find('\n')) != std::string::npos)
+        {
+            std::string response = handleServerRequest(game, pending.substr(0, newline));
+            pending.erase(0, newline + 1);
+
+            open = !response.empty() && writeAll(clientFd, response + "\n");
+        }
+    }
+    close(clientFd);
+}
+
+/* Serves requests from a Unix domain socket. Every connection gets a
+thread and a GameSession of its own, so clients are searched side by side
+and one slow search does not hold up the others. */
+bool runSocketServer(Engine &engine, const std::string &path)
+{
+    int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0)
+    {
+        std::cerr << "Could not create socket.\n";
+        return false;
+    }
+
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path))
+    {
+        std::cerr << "Socket path is too long: " << path << "\n";
+        close(listenFd);
+        return false;
+    }
+    std::strcpy(addr.sun_path, path.c_str());
+    unlink(path.c_str()); // remove a stale socket left by a previous run
+
+    if (bind(listenFd, (sockaddr *)&addr, sizeof(addr)) < 0 || listen(listenFd, 16) < 0)
+    {
+        std::cerr << "Could not listen on " << path << "\n";
+        close(listenFd);
+        return false;
+    }
+
+    // A client that disconnects before its answer arrives must not kill the server
+    signal(SIGPIPE, SIG_IGN);
+
+    while (true)
+    {
+        int clientFd = accept(listenFd, nullptr, nullptr);
+        if (clientFd < 0)
+        {
+            continue;
+        }
+
+        std::thread(serveConnection, std::ref(engine), clientFd).detach();
+    }
+}
+
+#else
+
+// serves requests from a Unix domain socket, every connection on its own thread and session
+bool runSocketServer(Engine &engine, const std::string &path)
+{
+    std::cerr << "Unix socket mode is not available on Windows, use --serve without a path.\n";
+    return false;
+}
+
+#endif
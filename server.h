@@ -0,0 +1,51 @@
+#pragma once
+
+#include "engine.h"
+#include "gamesession.h"
+#include <iostream>
+#include <string>
+
+/*
+
+Persistent engine server.
+
+Keeps the engine (opening book and transposition table) alive between
+requests instead of paying the start-up cost per position. Every client
+gets its own GameSession: stdin is one session, and on a Unix socket each
+connection is served on its own thread with its own session, so many
+games are searched at once against the one shared table and book.
+With --ponder it also keeps searching between requests: after every
+move it answers, the opponent's replies are searched into the table until
+that client's next line arrives.
+
+Protocol: one request per line, one JSON response per line.
+
+  request:  a move history such as "3342" (an empty line is the empty board),
+            "analyse <history>" for the exact scores of every legal move,
+            "analyse wdl <history>" to only tell wins, draws and losses apart,
+            "stats" for the telemetry of the session's last search (SearchStats::toJson),
+            or "quit" to close the connection
+  response: {"move":2,"score":14,"book":false,"proven":false,"nodes":81234,"time_ms":12}
+            ("proven" marks an exact score from a solve that ran to the end;
+            heuristic scores, book moves and searches stopped by --movetime
+            or --nodes are not proven)
+            {"error":"illegal move history"} (a move off the board, into a
+            full column or after a win), {"error":"game is over"} (the last
+            move won), {"error":"board is full"}
+  analyse:  {"moves":[{"move":3,"score":2,"bound":"exact","pv":"3324"},...],
+             "proven":true,"nodes":81234,"time_ms":12}
+            (best move first; "pv" is the line the search expects, starting
+            with the move; wdl scores a win as a "lower" bound of at least 1
+            and a loss as an "upper" bound of at most -1; a limit can leave other bounds; before the exact
+            solver takes over, the scores are depth-limited ones)
+
+*/
+
+// answers a single request line, returns an empty string for "quit"
+std::string handleServerRequest(GameSession &game, const std::string &line);
+
+// serves requests from a stream (stdin) until EOF or "quit"
+void runServer(GameSession &game, std::istream &in, std::ostream &out);
+
+// serves requests from a Unix domain socket, every connection on its own thread and session
+bool runSocketServer(Engine &engine, const std::string &path);
@@ -0,0 +1,250 @@
+#include "transpositiontable.h"
+#include <new> // bad_alloc
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+static const uint64_t VALID_BIT = 1ULL << 63;
+
+// whether an entry exists in the current generation of the table
+static bool isLive(uint64_t data, uint16_t generation)
+{
+    return (data & VALID_BIT) && (uint16_t)(data >> 36) == generation;
+}
+
+// packs a search result into the data word of an entry
+static uint64_t pack(int score, int depth, int move, int flag, uint8_t age, uint16_t generation)
+{
+    return VALID_BIT |
+           ((uint64_t)generation << 36) |
+           ((uint64_t)age << 28) |
+           ((uint64_t)(flag & 0x3) << 26) |
+           ((uint64_t)(move & 0xF) << 22) |
+           ((uint64_t)(depth & 0x3F) << 16) |
+           (uint64_t)(uint16_t)score;
+}
+
+TranspositionTable::TranspositionTable(size_t megabytes) : buckets(nullptr), bucketMask(0), mappedBytes(0),
+                                                          hugePages(false), age(0), generation(0)
+{
+    allocate(megabytes);
+}
+
+TranspositionTable::~TranspositionTable()
+{
+    release();
+}
+
+/* Maps the largest power-of-two number of buckets that fits in the given
+size. Nothing is written here: the pages arrive zeroed on first touch,
+and an all-zero entry is an empty one. */
+void TranspositionTable::allocate(size_t megabytes)
+{
+    uint64_t bytes = (uint64_t)(megabytes ? megabytes : 1) << 20;
+    uint64_t numBuckets = 1;
+    while (numBuckets * 2 * sizeof(TTBucket) <= bytes)
+    {
+        numBuckets *= 2;
+    }
+    mappedBytes = (size_t)(numBuckets * sizeof(TTBucket));
+    hugePages = false;
+
+    void *memory = nullptr;
+#ifdef _WIN32
+    // Committed pages are still only backed by memory once they are touched
+    memory = VirtualAlloc(nullptr, mappedBytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+#ifdef MAP_HUGETLB
+    /* Explicit huge pages only work if the administrator reserved some
+    (vm.nr_hugepages). No MAP_NORESERVE here: the kernel must reserve the
+    pages up front, or the mapping would succeed and then SIGBUS on touch. */
+    if (mappedBytes >= (2u << 20))
+    {
+        memory = mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (memory == MAP_FAILED)
+        {
+            memory = nullptr;
+        }
+        else
+        {
+            hugePages = true;
+        }
+    }
+#endif
+    if (!memory)
+    {
+        memory = mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (memory == MAP_FAILED)
+        {
+            memory = nullptr;
+        }
+#ifdef MADV_HUGEPAGE
+        else
+        {
+            madvise(memory, mappedBytes, MADV_HUGEPAGE); // transparent huge pages
+        }
+#endif
+    }
+#endif
+
+    if (!memory)
+    {
+        throw std::bad_alloc();
+    }
+
+    // The atomics are trivially constructible and zero bytes are a valid (empty) state
+    buckets = static_cast<TTBucket *>(memory);
+    bucketMask = numBuckets - 1;
+}
+
+// returns the mapping to the operating system
+void TranspositionTable::release()
+{
+    if (buckets)
+    {
+#ifdef _WIN32
+        VirtualFree(buckets, 0, MEM_RELEASE);
+#else
+        munmap(buckets, mappedBytes);
+#endif
+    }
+    buckets = nullptr;
+    bucketMask = 0;
+    mappedBytes = 0;
+}
+
+// replaces the table with an empty one of a different size
+void TranspositionTable::resize(size_t megabytes)
+{
+    release();
+    allocate(megabytes);
+    age = 0;
+    generation = 0;
+}
+
+// looks for an entry whose check word matches the hash
+bool TranspositionTable::probe(uint64_t hash, TTData &out) const
+{
+    const TTBucket &bucket = bucketFor(hash);
+
+    for (int i = 0; i < TTBucket::SIZE; i++)
+    {
+        uint64_t data = bucket.entries[i].data.load(std::memory_order_relaxed);
+        uint64_t check = bucket.entries[i].check.load(std::memory_order_relaxed);
+
+        if (isLive(data, generation) && (check ^ data) == hash)
+        {
+            out.score = (int16_t)(data & 0xFFFF);
+            out.depth = (int)((data >> 16) & 0x3F);
+            out.move = (int)((data >> 22) & 0xF);
+            out.flag = (int)((data >> 26) & 0x3);
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Stores a search result. The same position is always overwritten. Otherwise
+the entry is written to an empty slot if the bucket has one, or over the
+least valuable entry: shallow entries and entries left over from earlier
+searches go first. */
+TranspositionTable::StoreResult TranspositionTable::store(uint64_t hash, int score, int depth, int move, int flag)
+{
+    TTBucket &bucket = bucketFor(hash);
+
+    uint8_t currentAge = age.load(std::memory_order_relaxed);
+    int victim = 0;
+    int victimWorth = 1 << 30;
+    StoreResult result = REPLACED_OTHER;
+
+    for (int i = 0; i < TTBucket::SIZE; i++)
+    {
+        uint64_t data = bucket.entries[i].data.load(std::memory_order_relaxed);
+        uint64_t check = bucket.entries[i].check.load(std::memory_order_relaxed);
+
+        if (!isLive(data, generation))
+        {
+            victim = i;
+            result = FILLED_EMPTY; // empty, or left over from before the last clear()
+            break;
+        }
+        if ((check ^ data) == hash)
+        {
+            victim = i;
+            result = UPDATED;
+            break;
+        }
+
+        // Each search of age difference costs an entry as much as two plies of depth
+        int entryDepth = (int)((data >> 16) & 0x3F);
+        int entryAge = (int)((data >> 28) & 0xFF);
+        int worth = entryDepth - 2 * (uint8_t)(currentAge - entryAge);
+        if (worth < victimWorth)
+        {
+            victimWorth = worth;
+            victim = i;
+        }
+    }
+
+    uint64_t data = pack(score, depth, move, flag, currentAge, generation);
+    bucket.entries[victim].check.store(hash ^ data, std::memory_order_relaxed);
+    bucket.entries[victim].data.store(data, std::memory_order_relaxed);
+    return result;
+}
+
+// ages every entry by one search, making older entries cheaper to replace
+void TranspositionTable::newSearch()
+{
+    age.fetch_add(1, std::memory_order_relaxed);
+}
+
+/* Keeps every entry but makes them look 16 searches old, so positions
+from the new game replace them before anything the new game writes. */
+void TranspositionTable::newGame()
+{
+    age.fetch_add(16, std::memory_order_relaxed);
+}
+
+/* Empties the table in O(1) by starting a new generation. Only once the
+16-bit generation counter wraps around, and old entries could look
+current again, are the pages actually handed back to the operating
+system, which maps fresh zero pages the next time they are touched. */
+void TranspositionTable::clear()
+{
+    generation++;
+    if (generation == 0)
+    {
+#ifdef _WIN32
+        VirtualFree(buckets, mappedBytes, MEM_DECOMMIT);
+        VirtualAlloc(buckets, mappedBytes, MEM_COMMIT, PAGE_READWRITE);
+#else
+        madvise(buckets, mappedBytes, MADV_DONTNEED);
+#endif
+    }
+    age = 0;
+}
+
+// number of entries in the table
+uint64_t TranspositionTable::capacity() const
+{
+    return (bucketMask + 1) * TTBucket::SIZE;
+}
+
+// size of the table in megabytes
+size_t TranspositionTable::sizeInMB() const
+{
+    return mappedBytes >> 20;
+}
+
+// whether the table is backed by explicit huge pages
+bool TranspositionTable::usingHugePages() const
+{
+    return hugePages;
+}
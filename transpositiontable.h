@@ -0,0 +1,122 @@
+#pragma once
+
+#include "platform.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/*
+
+Transposition table layout:
+
+Every 64-byte cache line is a bucket of four 16-byte entries, so a probe
+touches exactly one line. An entry is two 64-bit words:
+
+  check = hash ^ data
+  data  = packed search result
+
+  bit  63      valid (set on every stored entry)
+  bits 51..36  generation (table contents the entry belongs to)
+  bits 35..28  age (search number the entry was written in)
+  bits 27..26  flag (0 exact, 1 lower bound, 2 upper bound)
+  bits 25..22  best move (TT_NO_MOVE = none; 4 bits fit boards up to 15 wide)
+  bits 21..16  depth
+  bits 15..0   score (int16)
+
+Both words are written and read with relaxed atomics and no locks. If two
+threads write the same entry at the same time a reader can see one word
+from each write, but then check ^ data no longer equals the probed hash,
+so the torn entry is simply treated as a miss.
+
+Age and generation do different jobs. The age only decides which entry of
+a full bucket gets replaced. The generation decides whether an entry
+exists at all: clear() just starts a new generation, and probes treat
+entries from older generations as empty. That makes wiping the table
+O(1) instead of a sweep over every page. newGame() keeps the entries
+(they are still correct, and the opening is searched again every game)
+but ages them so the new game's results replace them first. Concurrent
+games share one table, so newSearch() and newGame() may be called from
+several threads at once; clear() and resize() may not run while anything
+searches.
+
+The buckets live in an anonymous memory mapping rather than a vector. The
+operating system hands out zeroed pages the first time they are touched,
+so allocating even a multi-gigabyte table is instant and a process that
+only plays book moves never pays for it. On Linux the mapping uses
+explicit huge pages when some are reserved, and transparent huge pages
+otherwise, to cut TLB misses on random probes.
+
+*/
+
+struct TTEntry
+{
+    std::atomic<uint64_t> check;
+    std::atomic<uint64_t> data;
+};
+
+struct alignas(64) TTBucket
+{
+    static const int SIZE = 4;
+    TTEntry entries[SIZE];
+};
+
+// best move of an entry that has none
+static const int TT_NO_MOVE = 15;
+
+// unpacked transposition table entry
+struct TTData
+{
+    int score;
+    int depth;
+    int move;
+    int flag;
+};
+
+class TranspositionTable
+{
+private:
+    TTBucket *buckets;
+    uint64_t bucketMask;
+    size_t mappedBytes;
+    bool hugePages; // backed by explicit huge pages
+    std::atomic<uint8_t> age; // bumped by the searches of every session at once
+    uint16_t generation;
+
+    void allocate(size_t megabytes);
+    void release();
+
+    TTBucket &bucketFor(uint64_t hash) const
+    {
+        return buckets[hash & bucketMask];
+    }
+
+public:
+    // outcome of a store, used for the fill and collision statistics
+    enum StoreResult
+    {
+        FILLED_EMPTY,
+        UPDATED,
+        REPLACED_OTHER
+    };
+
+    explicit TranspositionTable(size_t megabytes);
+    ~TranspositionTable();
+    TranspositionTable(const TranspositionTable &) = delete;
+    TranspositionTable &operator=(const TranspositionTable &) = delete;
+
+    bool probe(uint64_t hash, TTData &out) const;
+    StoreResult store(uint64_t hash, int score, int depth, int move, int flag);
+    void newSearch();
+    void newGame();
+    void clear();
+    void resize(size_t megabytes);
+    uint64_t capacity() const; // number of entries
+    size_t sizeInMB() const;
+    bool usingHugePages() const;
+
+    // starts loading the bucket for a hash into cache before it is probed
+    void prefetch(uint64_t hash) const
+    {
+        ::prefetch(&bucketFor(hash));
+    }
+};